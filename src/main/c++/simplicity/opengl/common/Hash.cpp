@@ -0,0 +1,40 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include "Hash.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace Hash
+		{
+			uint64_t fnv1a(const char* data, size_t length, uint64_t seed)
+			{
+				uint64_t hash = 14695981039346656037ull ^ seed;
+				for (size_t index = 0; index < length; index++)
+				{
+					hash ^= static_cast<unsigned char>(data[index]);
+					hash *= 1099511628211ull;
+				}
+
+				return hash;
+			}
+
+			uint64_t fnv1a(const string& data, uint64_t seed)
+			{
+				return fnv1a(data.data(), data.size(), seed);
+			}
+		}
+	}
+}
@@ -0,0 +1,40 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef HASH_H_
+#define HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace Hash
+		{
+			/**
+			 * <p>
+			 * Hashes some data (64 bit FNV-1a). Pass the result of a previous call as the seed to hash several
+			 * pieces of data together.
+			 * </p>
+			 */
+			SIMPLE_API std::uint64_t fnv1a(const char* data, std::size_t length, std::uint64_t seed = 0);
+
+			SIMPLE_API std::uint64_t fnv1a(const std::string& data, std::uint64_t seed = 0);
+		}
+	}
+}
+
+#endif /* HASH_H_ */
@@ -0,0 +1,129 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+#ifdef _WIN32
+		MappedFile::MappedFile(const string& path) :
+			data(nullptr),
+			file(INVALID_HANDLE_VALUE),
+			mapping(nullptr),
+			size(0)
+		{
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+					FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return;
+			}
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+			{
+				return;
+			}
+
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping == nullptr)
+			{
+				return;
+			}
+
+			data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (data != nullptr)
+			{
+				size = static_cast<size_t>(fileSize.QuadPart);
+			}
+		}
+
+		MappedFile::~MappedFile()
+		{
+			if (data != nullptr)
+			{
+				UnmapViewOfFile(data);
+			}
+
+			if (mapping != nullptr)
+			{
+				CloseHandle(mapping);
+			}
+
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(file);
+			}
+		}
+#else
+		MappedFile::MappedFile(const string& path) :
+			data(nullptr),
+			size(0)
+		{
+			int file = open(path.c_str(), O_RDONLY);
+			if (file == -1)
+			{
+				return;
+			}
+
+			struct stat fileStatus;
+			if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0)
+			{
+				void* mappedData = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+				if (mappedData != MAP_FAILED)
+				{
+					data = static_cast<const char*>(mappedData);
+					size = static_cast<size_t>(fileStatus.st_size);
+				}
+			}
+
+			// The mapping stays valid after the file is closed.
+			close(file);
+		}
+
+		MappedFile::~MappedFile()
+		{
+			if (data != nullptr)
+			{
+				munmap(const_cast<char*>(data), size);
+			}
+		}
+#endif
+
+		const char* MappedFile::getData() const
+		{
+			return data;
+		}
+
+		size_t MappedFile::getSize() const
+		{
+			return size;
+		}
+
+		bool MappedFile::isOpen() const
+		{
+			return data != nullptr;
+		}
+	}
+}
@@ -0,0 +1,66 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * A read only file mapped into memory.
+		 * </p>
+		 */
+		class SIMPLE_API MappedFile
+		{
+			public:
+				/**
+				 * @param path The path of the file to map.
+				 */
+				MappedFile(const std::string& path);
+
+				~MappedFile();
+
+				MappedFile(const MappedFile&) = delete;
+
+				MappedFile& operator=(const MappedFile&) = delete;
+
+				const char* getData() const;
+
+				std::size_t getSize() const;
+
+				/**
+				 * @return True if the file was mapped successfully, false otherwise.
+				 */
+				bool isOpen() const;
+
+			private:
+				const char* data;
+
+#ifdef _WIN32
+				void* file;
+
+				void* mapping;
+#endif
+
+				std::size_t size;
+		};
+	}
+}
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,93 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <map>
+#include <vector>
+
+#include <simplicity/logging/Logs.h>
+
+#include "OpenGL.h"
+#include "OpenGLBuffer.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace
+		{
+			struct BoundRange
+			{
+				const OpenGLBuffer* buffer;
+
+				unsigned int offset;
+
+				unsigned int size;
+			};
+
+			map<GLenum, vector<BoundRange>> boundRanges;
+		}
+
+		OpenGLBuffer::~OpenGLBuffer()
+		{
+			// The name may be reused by the next buffer created.
+			for (pair<const GLenum, vector<BoundRange>>& targetRanges : boundRanges)
+			{
+				for (BoundRange& boundRange : targetRanges.second)
+				{
+					if (boundRange.buffer == this)
+					{
+						boundRange = { nullptr, 0, 0 };
+					}
+				}
+			}
+		}
+
+		void OpenGLBuffer::bindRange(GLenum target, GLuint index, unsigned int offset, unsigned int size) const
+		{
+			if (size == 0 && offset != 0)
+			{
+				Logs::error("simplicity::opengl", "Cannot bind the whole of a buffer from offset %u.", offset);
+				return;
+			}
+
+			vector<BoundRange>& targetRanges = boundRanges[target];
+			if (targetRanges.size() <= index)
+			{
+				targetRanges.resize(index + 1, { nullptr, 0, 0 });
+			}
+
+			BoundRange& boundRange = targetRanges[index];
+			if (boundRange.buffer == this && boundRange.offset == offset && boundRange.size == size)
+			{
+				return;
+			}
+
+			if (size == 0)
+			{
+				glBindBufferBase(target, index, getName());
+			}
+			else
+			{
+				glBindBufferRange(target, index, getName(), offset, size);
+			}
+			OpenGL::checkError();
+
+			boundRange = { this, offset, size };
+		}
+
+		void OpenGLBuffer::resetBindings()
+		{
+			boundRanges.clear();
+		}
+	}
+}
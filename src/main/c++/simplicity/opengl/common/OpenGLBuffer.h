@@ -29,11 +29,39 @@ namespace simplicity
 		 * <p>
 		 * An OpenGL buffer.
 		 * </p>
+		 *
+		 * <p>
+		 * The ranges bound to indexed binding points through bindRange() are remembered so binding the same range
+		 * again costs nothing. Buffers forget their bindings when they are destroyed, anything else that binds
+		 * buffers to those binding points must call resetBindings().
+		 * </p>
 		 */
 		class SIMPLE_API OpenGLBuffer : public Buffer
 		{
 			public:
+				virtual ~OpenGLBuffer();
+
+				/**
+				 * <p>
+				 * Binds a range of this buffer to an indexed binding point, unless it is already bound there.
+				 * </p>
+				 *
+				 * @param target The indexed target, e.g. GL_UNIFORM_BUFFER.
+				 * @param index The binding point.
+				 * @param offset The offset of the range in bytes. Must be 0 when binding the whole buffer.
+				 * @param size The size of the range in bytes, 0 binds the whole buffer.
+				 */
+				void bindRange(GLenum target, GLuint index, unsigned int offset, unsigned int size) const;
+
 				virtual GLuint getName() const = 0;
+
+				/**
+				 * <p>
+				 * Forgets which ranges are bound to the indexed binding points, e.g. after buffers have been bound to
+				 * them without going through bindRange().
+				 * </p>
+				 */
+				static void resetBindings();
 		};
 	}
 }
@@ -36,6 +36,15 @@ namespace simplicity
 			OpenGL::checkError();
 		}
 
+		bool OpenGLFence::isSignaled() const
+		{
+			GLint status = GL_UNSIGNALED;
+			glGetSynciv(fence, GL_SYNC_STATUS, sizeof(status), nullptr, &status);
+			OpenGL::checkError();
+
+			return status == GL_SIGNALED;
+		}
+
 		void OpenGLFence::wait() const
 		{
 			// First do a quick check.
@@ -37,6 +37,15 @@ namespace simplicity
 
 				~OpenGLFence();
 
+				/**
+				 * <p>
+				 * Determines whether the GPU has passed this fence without blocking.
+				 * </p>
+				 *
+				 * @return True if the fence has been signaled, false otherwise.
+				 */
+				bool isSignaled() const;
+
 				void wait() const;
 
 			private:
@@ -0,0 +1,134 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include "OpenGL.h"
+#include "OpenGLTimer.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		OpenGLTimer::OpenGLTimer() :
+			active(false),
+			initialized(false),
+			last(0.0),
+			next(0),
+			pending(),
+			queries(),
+			sampleCount(0),
+			total(0.0)
+		{
+		}
+
+		OpenGLTimer::~OpenGLTimer()
+		{
+			if (initialized)
+			{
+				glDeleteQueries(QUERY_COUNT, queries);
+			}
+		}
+
+		void OpenGLTimer::begin()
+		{
+			// The queries need a context so they cannot be created in the constructor.
+			if (!initialized)
+			{
+				glGenQueries(QUERY_COUNT, queries);
+				OpenGL::checkError();
+				initialized = true;
+			}
+
+			update();
+
+			if (pending[next])
+			{
+				return;
+			}
+
+			glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+			OpenGL::checkError();
+			active = true;
+		}
+
+		void OpenGLTimer::end()
+		{
+			if (!active)
+			{
+				return;
+			}
+
+			glEndQuery(GL_TIME_ELAPSED);
+			OpenGL::checkError();
+
+			pending[next] = true;
+			next = (next + 1) % QUERY_COUNT;
+			active = false;
+		}
+
+		double OpenGLTimer::getAverage() const
+		{
+			if (sampleCount == 0)
+			{
+				return 0.0;
+			}
+
+			return total / sampleCount;
+		}
+
+		double OpenGLTimer::getLast() const
+		{
+			return last;
+		}
+
+		unsigned int OpenGLTimer::getSampleCount() const
+		{
+			return sampleCount;
+		}
+
+		void OpenGLTimer::reset()
+		{
+			last = 0.0;
+			sampleCount = 0;
+			total = 0.0;
+		}
+
+		void OpenGLTimer::update()
+		{
+			// Results become available in the order the queries were issued, so start from the oldest.
+			for (unsigned int offset = 0; offset < QUERY_COUNT; offset++)
+			{
+				unsigned int index = (next + offset) % QUERY_COUNT;
+				if (!pending[index])
+				{
+					continue;
+				}
+
+				GLuint available = GL_FALSE;
+				glGetQueryObjectuiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+				OpenGL::checkError();
+
+				if (available == GL_FALSE)
+				{
+					break;
+				}
+
+				GLuint64 elapsed = 0;
+				glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &elapsed);
+				OpenGL::checkError();
+
+				last = elapsed / 1000000.0;
+				total += last;
+				sampleCount++;
+				pending[index] = false;
+			}
+		}
+	}
+}
@@ -0,0 +1,102 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLTIMER_H_
+#define OPENGLTIMER_H_
+
+#include <GL/glew.h>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Measures the GPU time taken by the commands issued between begin() and end() using timer queries. Results are
+		 * collected a few frames later when the GPU has them ready, the CPU never waits for them. Timers cannot be
+		 * nested.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLTimer
+		{
+			public:
+				OpenGLTimer();
+
+				~OpenGLTimer();
+
+				/**
+				 * <p>
+				 * Starts timing. If every query is still waiting for a result this measurement is skipped.
+				 * </p>
+				 */
+				void begin();
+
+				/**
+				 * <p>
+				 * Stops timing.
+				 * </p>
+				 */
+				void end();
+
+				/**
+				 * @return The average of the collected measurements in milliseconds.
+				 */
+				double getAverage() const;
+
+				/**
+				 * @return The last collected measurement in milliseconds.
+				 */
+				double getLast() const;
+
+				/**
+				 * @return The number of collected measurements.
+				 */
+				unsigned int getSampleCount() const;
+
+				/**
+				 * <p>
+				 * Discards the collected measurements.
+				 * </p>
+				 */
+				void reset();
+
+				/**
+				 * <p>
+				 * Collects any results the GPU has ready.
+				 * </p>
+				 */
+				void update();
+
+			private:
+				static const unsigned int QUERY_COUNT = 4;
+
+				bool active;
+
+				bool initialized;
+
+				double last;
+
+				unsigned int next;
+
+				bool pending[QUERY_COUNT];
+
+				GLuint queries[QUERY_COUNT];
+
+				unsigned int sampleCount;
+
+				double total;
+		};
+	}
+}
+
+#endif /* OPENGLTIMER_H_ */
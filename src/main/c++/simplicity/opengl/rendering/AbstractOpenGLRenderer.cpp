@@ -20,7 +20,9 @@
 
 #include "../common/OpenGL.h"
 #include "AbstractOpenGLRenderer.h"
+#include "OpenGLClears.h"
 #include "OpenGLPipeline.h"
+#include "OpenGLRenderingEngine.h"
 
 using namespace std;
 
@@ -33,7 +35,9 @@ namespace simplicity
 				clearDepthBuffer(true),
 				clearingColor(0.0f, 0.0f, 0.0f, 1.0f),
 				clearStencilBuffer(true),
-				pipeline()
+				pipeline(),
+				renderState(),
+				scissorEnabled(false)
 		{
 		}
 
@@ -54,6 +58,12 @@ namespace simplicity
 
 		void AbstractOpenGLRenderer::dispose()
 		{
+			// Lists deferred for the depth pre-pass need this renderer's camera, parameters and scissor.
+			OpenGLRenderingEngine::flushDeferred();
+
+			// The scissor test is this renderer's, it must not carry over to whatever is drawn next.
+			OpenGLRenderState::setScissorTestForced(false);
+
 			// Revert clearing settings.
 			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 			OpenGL::checkError();
@@ -97,37 +107,39 @@ namespace simplicity
 
 		void AbstractOpenGLRenderer::init()
 		{
+			// Merged with the clear the engine (and any other renderer) wants for the target, so it is cleared once.
+			GLbitfield clearMask = 0;
 			if (clearColorBuffer)
 			{
-				glClearColor(clearingColor.X(), clearingColor.Y(), clearingColor.Z(), clearingColor.W());
-				OpenGL::checkError();
-				glClear(GL_COLOR_BUFFER_BIT);
-				OpenGL::checkError();
+				clearMask |= GL_COLOR_BUFFER_BIT;
 			}
 			if (clearDepthBuffer)
 			{
-				glClear(GL_DEPTH_BUFFER_BIT);
-				OpenGL::checkError();
+				clearMask |= GL_DEPTH_BUFFER_BIT;
 			}
 			if (clearStencilBuffer)
 			{
-				glClear(GL_STENCIL_BUFFER_BIT);
-				OpenGL::checkError();
+				clearMask |= GL_STENCIL_BUFFER_BIT;
 			}
 
+			OpenGLClears::suppress(~clearMask);
+			OpenGLClears::request(clearMask, clearingColor);
+			OpenGLClears::flush();
+
+			// Applies on top of whichever pipelines are drawn with until dispose().
+			OpenGLRenderState::setScissorTestForced(scissorEnabled);
+
 			// Provide the default pipeline.
 			if (pipeline == nullptr)
 			{
 				pipeline = RenderingFactory::createPipeline();
+				updatePipelineRenderState();
 			}
 		}
 
 		bool AbstractOpenGLRenderer::isScissorEnabled() const
 		{
-			GLboolean enabled = glIsEnabled(GL_SCISSOR_TEST);
-			OpenGL::checkError();
-
-			return enabled == GL_TRUE;
+			return scissorEnabled;
 		}
 
 		void AbstractOpenGLRenderer::setClearBuffers(bool clearBuffers)
@@ -170,21 +182,32 @@ namespace simplicity
 
 		void AbstractOpenGLRenderer::setScissorEnabled(bool scissorEnabled)
 		{
-			if (scissorEnabled)
-			{
-				glEnable(GL_SCISSOR_TEST);
-				OpenGL::checkError();
-			}
-			else
-			{
-				glDisable(GL_SCISSOR_TEST);
-				OpenGL::checkError();
-			}
+			this->scissorEnabled = scissorEnabled;
+
+			// Takes effect straight away too, as it always has.
+			OpenGLRenderState::setScissorTestForced(scissorEnabled);
 		}
 
 		void AbstractOpenGLRenderer::setDefaultPipeline(unique_ptr<Pipeline> pipeline)
 		{
 			this->pipeline = move(pipeline);
+			updatePipelineRenderState();
+		}
+
+		void AbstractOpenGLRenderer::setRenderState(shared_ptr<const OpenGLRenderState> renderState)
+		{
+			this->renderState = renderState;
+			updatePipelineRenderState();
+		}
+
+		void AbstractOpenGLRenderer::updatePipelineRenderState()
+		{
+			if (pipeline == nullptr)
+			{
+				return;
+			}
+
+			static_cast<OpenGLPipeline*>(pipeline.get())->setRenderState(renderState);
 		}
 	}
 }
@@ -19,6 +19,8 @@
 
 #include <simplicity/rendering/Renderer.h>
 
+#include "OpenGLRenderState.h"
+
 namespace simplicity
 {
 	namespace opengl
@@ -50,6 +52,16 @@ namespace simplicity
 
 				bool isScissorEnabled() const override;
 
+				/**
+				 * <p>
+				 * Sets whether all the buffers are cleared when this renderer is initialized each frame. The clear is
+				 * merged with the one the frame graph wants for the target (see OpenGLClears), so not clearing the
+				 * buffers also cancels the engine's clear of the scene target for this frame, keeping what was drawn
+				 * into it before. Buffers an earlier renderer already cleared for the target are not cleared again.
+				 * </p>
+				 *
+				 * @param clearBuffers Determines whether all the buffers are cleared.
+				 */
 				void setClearBuffers(bool clearBuffers) override;
 
 				void setClearColorBuffer(bool clearColorBuffer) override;
@@ -66,6 +78,17 @@ namespace simplicity
 
 				void setDefaultPipeline(std::unique_ptr<Pipeline> pipeline) override;
 
+				/**
+				 * <p>
+				 * Sets the fixed-function state this renderer's pipeline is applied with. While the renderer's scissor
+				 * test is enabled it is forced on over this state and that of any other pipeline (see
+				 * OpenGLRenderState::setScissorTestForced()).
+				 * </p>
+				 *
+				 * @param renderState The state, nullptr to use the default (see OpenGLRenderState::getDefault()).
+				 */
+				void setRenderState(std::shared_ptr<const OpenGLRenderState> renderState);
+
 			protected:
 				int getOpenGLDrawingMode(MeshBuffer::PrimitiveType primitiveType);
 
@@ -79,6 +102,12 @@ namespace simplicity
 				bool clearStencilBuffer;
 
 				std::shared_ptr<Pipeline> pipeline;
+
+				std::shared_ptr<const OpenGLRenderState> renderState;
+
+				bool scissorEnabled;
+
+				void updatePipelineRenderState();
 		};
 	}
 }
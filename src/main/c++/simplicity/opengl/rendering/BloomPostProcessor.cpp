@@ -9,15 +9,21 @@
  *
  * This file is part of simplicity. See the LICENSE file for the full license governing this code.
  */
+#include <algorithm>
+
 #include <GL/glew.h>
 
-#include <simplicity/model/ModelFactory.h>
 #include <simplicity/rendering/RenderingFactory.h>
 #include <simplicity/rendering/AbstractRenderingEngine.h>
+#include <simplicity/logging/Logs.h>
 #include <simplicity/resources/Resources.h>
 
 #include "../common/OpenGL.h"
 #include "BloomPostProcessor.h"
+#include "OpenGLClears.h"
+#include "OpenGLPipeline.h"
+#include "OpenGLRenderTargetPool.h"
+#include "OpenGLRenderingFactory.h"
 #include "OpenGLTexture.h"
 
 using namespace std;
@@ -26,49 +32,125 @@ namespace simplicity
 {
 	namespace opengl
 	{
-		BloomPostProcessor::BloomPostProcessor() :
-			pingFrameBuffer(RenderingFactory::createFrameBuffer(
-					{
-							RenderingFactory::createTexture(nullptr, 800, 600, PixelFormat::RGB_HDR)
-					},
-					false)),
-			pongFrameBuffer(RenderingFactory::createFrameBuffer(
-					{
-							RenderingFactory::createTexture(nullptr, 800, 600, PixelFormat::RGB_HDR)
-					},
-					false)),
-			quad(new Model),
-			renderList()
-		{
-			ModelFactory::Recipe quadRecipe;
-			quadRecipe.shape = ModelFactory::Recipe::Shape::RECTANGLE;
-			quadRecipe.dimensions[0] = 2.0f;
-			quadRecipe.dimensions[1] = 2.0f;
-			std::shared_ptr<Mesh> quadMesh(ModelFactory::cookMesh(quadRecipe));
-			MeshData& quadData = quadMesh->getData(true);
-			quadData.vertexData[0].texCoord.Y() *= -1;
-			quadData.vertexData[1].texCoord.Y() *= -1;
-			quadData.vertexData[2].texCoord.Y() *= -1;
-			quadData.vertexData[3].texCoord.Y() *= -1;
-			quadMesh->releaseData();
-			quad->setMesh(quadMesh);
-
-			renderList.buffer = quad->getMesh()->getBuffer();
-			renderList.list = { pair<Model*, Matrix44>(quad.get(), Matrix44()) };
+		namespace
+		{
+			// The work group sizes of ShaderSource::computeGaussianBlur.
+			const unsigned int COMBINED_TILE_SIZE = 16;
+
+			const unsigned int TILE_SIZE = 128;
+
+			unsigned int getGroupCount(unsigned int pixels, unsigned int tileSize)
+			{
+				return (pixels + tileSize - 1) / tileSize;
+			}
 		}
 
-		void BloomPostProcessor::process(RenderingEngine& engine)
+		BloomPostProcessor::BloomPostProcessor(Mode mode, float scale) :
+			blendPipeline(),
+			blurProgram(),
+			combinedDispatch(false),
+			combinedBlurProgram(),
+			computeEnabled(true),
+			downsamplePipeline(),
+			downsampleRenderState(),
+			gaussianPipeline(),
+			gaussianTimer(),
+			mipChain(),
+			mipChainTimer(),
+			mode(mode),
+			pingFrameBuffer(),
+			pongFrameBuffer(),
+			renderState(),
+			scale(scale),
+			upsamplePipeline(),
+			upsampleRenderState()
 		{
-			OpenGLRenderingEngine& openGLEngine = static_cast<OpenGLRenderingEngine&>(engine);
+			// Full screen passes have no use for depth testing or culling, the blending is kept as it was.
+			OpenGLRenderState::Description postProcess = OpenGLRenderState::getPostProcess().getDescription();
+			OpenGLRenderState::Description description = postProcess;
+			description.blend = true;
+			description.blendDestination = GL_ONE_MINUS_SRC_ALPHA;
+			description.blendSource = GL_SRC_ALPHA;
+			renderState.reset(new OpenGLRenderState(description));
 
-			shared_ptr<Pipeline> gaussianPipeline = RenderingFactory::createPipeline(
-					RenderingFactory::createShader(Shader::Type::VERTEX, "clip"),
-					nullptr,
-					RenderingFactory::createShader(Shader::Type::FRAGMENT, *Resources::get("glsl/fragmentGaussian.glsl")));
-			gaussianPipeline->apply();
+			downsampleRenderState.reset(new OpenGLRenderState(postProcess));
 
-			quad->getMesh()->getBuffer()->setPipeline(gaussianPipeline);
-			renderList.pipeline = renderList.buffer->getPipeline();
+			OpenGLRenderState::Description additive = postProcess;
+			additive.blend = true;
+			additive.blendDestination = GL_ONE;
+			additive.blendSource = GL_ONE;
+			upsampleRenderState.reset(new OpenGLRenderState(additive));
+		}
+
+		void BloomPostProcessor::acquireTargets(const OpenGLRenderingEngine& engine)
+		{
+			unsigned int width = max(static_cast<unsigned int>(engine.getWidth() * scale), 1u);
+			unsigned int height = max(static_cast<unsigned int>(engine.getHeight() * scale), 1u);
+
+			if (mode == Mode::GAUSSIAN)
+			{
+				// Images written by compute shaders cannot have three channels.
+				PixelFormat format = isComputeUsed() ? PixelFormat::RGBA_HDR : PixelFormat::RGB_HDR;
+				pingFrameBuffer = OpenGLRenderTargetPool::acquire(width, height, format);
+				pongFrameBuffer = OpenGLRenderTargetPool::acquire(width, height, format);
+			}
+			else
+			{
+				for (unsigned int level = 0; level < MIP_CHAIN_LEVELS && width > 1 && height > 1; level++)
+				{
+					width /= 2;
+					height /= 2;
+					mipChain.push_back(OpenGLRenderTargetPool::acquire(width, height, PixelFormat::RGB_HDR));
+				}
+			}
+		}
+
+		void BloomPostProcessor::blend(OpenGLRenderingEngine& engine, const shared_ptr<Texture>& source,
+				const Texture& bloom, FrameBuffer* target)
+		{
+			bindTarget(engine, target);
+
+			// The blend mixes with whatever is in the target so it is cleared first, through the clears so the render
+			// state shadow is kept in step.
+			GLbitfield mask = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+			OpenGLClears::begin(mask, mask);
+			OpenGLClears::flush();
+
+			// Created once and kept, so the program is not linked again every frame.
+			if (blendPipeline == nullptr)
+			{
+				blendPipeline = RenderingFactory::createPipeline(
+						RenderingFactory::createShader(Shader::Type::VERTEX, "fullscreenTriangle"),
+						nullptr,
+						RenderingFactory::createShader(Shader::Type::FRAGMENT,
+								*Resources::get("glsl/fragmentBlend.glsl")));
+				static_pointer_cast<OpenGLPipeline>(blendPipeline)->setRenderState(renderState);
+			}
+			blendPipeline->apply();
+
+			glActiveTexture(GL_TEXTURE1);
+			OpenGL::checkError();
+			glBindTexture(GL_TEXTURE_2D, static_cast<const OpenGLTexture&>(bloom).getTexture());
+			OpenGL::checkError();
+
+			blendPipeline->set("sampler", 0);
+			blendPipeline->set("bloom", 1);
+
+			draw(blendPipeline, source);
+		}
+
+		shared_ptr<Texture> BloomPostProcessor::blurGaussian(OpenGLRenderingEngine& engine)
+		{
+			if (gaussianPipeline == nullptr)
+			{
+				gaussianPipeline = RenderingFactory::createPipeline(
+						RenderingFactory::createShader(Shader::Type::VERTEX, "fullscreenTriangle"),
+						nullptr,
+						RenderingFactory::createShader(Shader::Type::FRAGMENT,
+								*Resources::get("glsl/fragmentGaussian.glsl")));
+				static_pointer_cast<OpenGLPipeline>(gaussianPipeline)->setRenderState(renderState);
+			}
+			gaussianPipeline->apply();
 
 			FrameBuffer* source = pingFrameBuffer.get();
 			FrameBuffer* target = pongFrameBuffer.get();
@@ -83,9 +165,7 @@ namespace simplicity
 				shared_ptr<Texture> sourceTexture =
 						first ? engine.getFrameBuffer()->getTextures()[1] : source->getTextures()[0];
 
-				quad->setTexture(sourceTexture);
-
-				openGLEngine.render(renderList);
+				draw(gaussianPipeline, sourceTexture);
 
 				FrameBuffer* temp = source;
 				source = target;
@@ -95,33 +175,235 @@ namespace simplicity
 				if (first) first = false;
 			}
 
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
-			OpenGL::checkError();
-			glViewport(0, 0, 800, 600);
-			OpenGL::checkError();
+			return source->getTextures()[0];
+		}
 
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-			OpenGL::checkError();
+		shared_ptr<Texture> BloomPostProcessor::blurGaussianCompute(OpenGLRenderingEngine& engine)
+		{
+			unique_ptr<OpenGLComputeProgram>& program = combinedDispatch ? combinedBlurProgram : blurProgram;
+			if (program == nullptr)
+			{
+				vector<string> defines;
+				if (combinedDispatch)
+				{
+					defines.push_back("BOTH_DIRECTIONS");
+				}
 
-			shared_ptr<Pipeline> blendPipeline = RenderingFactory::createPipeline(
-					RenderingFactory::createShader(Shader::Type::VERTEX, "clip"),
-					nullptr,
-					RenderingFactory::createShader(Shader::Type::FRAGMENT, *Resources::get("glsl/fragmentBlend.glsl")));
-			blendPipeline->apply();
+				program = OpenGLRenderingFactory::createComputeProgram("gaussianBlur", defines);
+			}
+			program->apply();
 
-			glActiveTexture(GL_TEXTURE1);
-			OpenGL::checkError();
-			glBindTexture(GL_TEXTURE_2D, static_pointer_cast<OpenGLTexture>(source->getTextures()[0])->getTexture());
+			// The textures are read through unit 0 and written through image unit 0, as declared in the shader.
+			glActiveTexture(GL_TEXTURE0);
 			OpenGL::checkError();
 
-			quad->getMesh()->getBuffer()->setPipeline(blendPipeline);
-			quad->setTexture(engine.getFrameBuffer()->getTextures()[0]);
-			renderList.pipeline = renderList.buffer->getPipeline();
+			shared_ptr<Texture> source = engine.getFrameBuffer()->getTextures()[1];
+			FrameBuffer* target = pingFrameBuffer.get();
+			FrameBuffer* spare = pongFrameBuffer.get();
+			unsigned int iterations = 5;
+			unsigned int passes = combinedDispatch ? iterations : iterations * 2;
+			for (unsigned int pass = 0; pass < passes; pass++)
+			{
+				const OpenGLTexture& targetTexture = static_cast<const OpenGLTexture&>(*target->getTextures()[0]);
+				unsigned int width = targetTexture.getWidth();
+				unsigned int height = targetTexture.getHeight();
+
+				glBindTexture(GL_TEXTURE_2D, static_cast<const OpenGLTexture&>(*source).getTexture());
+				OpenGL::checkError();
+				glBindImageTexture(0, targetTexture.getTexture(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+				OpenGL::checkError();
 
-			blendPipeline->set("sampler", 0);
-			blendPipeline->set("bloom", 1);
+				if (combinedDispatch)
+				{
+					program->dispatch(getGroupCount(width, COMBINED_TILE_SIZE),
+							getGroupCount(height, COMBINED_TILE_SIZE));
+				}
+				else if (pass % 2 == 0)
+				{
+					program->set("horizontal", 1);
+					program->dispatch(getGroupCount(width, TILE_SIZE), height);
+				}
+				else
+				{
+					// Work groups run along the blur direction, so columns are laid out along x.
+					program->set("horizontal", 0);
+					program->dispatch(getGroupCount(height, TILE_SIZE), width);
+				}
+
+				// The next pass (or the blend) samples what this one wrote.
+				glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+				OpenGL::checkError();
+
+				source = target->getTextures()[0];
+				swap(target, spare);
+			}
+
+			return source;
+		}
+
+		shared_ptr<Texture> BloomPostProcessor::blurMipChain(OpenGLRenderingEngine& engine)
+		{
+			// Too small to halve even once (e.g. a minimized window), there is nothing to blur.
+			if (mipChain.empty())
+			{
+				return engine.getFrameBuffer()->getTextures()[1];
+			}
+
+			// Down the chain, each level filtered from the one above it.
+			if (downsamplePipeline == nullptr)
+			{
+				downsamplePipeline = RenderingFactory::createPipeline(
+						RenderingFactory::createShader(Shader::Type::VERTEX, "fullscreenTriangle"),
+						nullptr,
+						RenderingFactory::createShader(Shader::Type::FRAGMENT, "bloomDownsample"));
+				static_pointer_cast<OpenGLPipeline>(downsamplePipeline)->setRenderState(downsampleRenderState);
+			}
+			downsamplePipeline->apply();
+			downsamplePipeline->set("sampler", 0);
+
+			shared_ptr<Texture> source = engine.getFrameBuffer()->getTextures()[1];
+			for (unique_ptr<FrameBuffer>& level : mipChain)
+			{
+				level->apply();
+				Vector2 texelSize(1.0f / source->getWidth(), 1.0f / source->getHeight());
+				downsamplePipeline->set("texelSize", texelSize);
 
-			openGLEngine.render(renderList);
+				draw(downsamplePipeline, source);
+
+				source = level->getTextures()[0];
+			}
+
+			// Back up the chain, each level blurred and added onto the one above it.
+			if (upsamplePipeline == nullptr)
+			{
+				upsamplePipeline = RenderingFactory::createPipeline(
+						RenderingFactory::createShader(Shader::Type::VERTEX, "fullscreenTriangle"),
+						nullptr,
+						RenderingFactory::createShader(Shader::Type::FRAGMENT, "bloomUpsample"));
+				static_pointer_cast<OpenGLPipeline>(upsamplePipeline)->setRenderState(upsampleRenderState);
+			}
+			upsamplePipeline->apply();
+			upsamplePipeline->set("sampler", 0);
+
+			for (size_t level = mipChain.size() - 1; level > 0; level--)
+			{
+				mipChain[level - 1]->apply();
+				source = mipChain[level]->getTextures()[0];
+				Vector2 texelSize(1.0f / source->getWidth(), 1.0f / source->getHeight());
+				upsamplePipeline->set("texelSize", texelSize);
+
+				draw(upsamplePipeline, source);
+			}
+
+			return mipChain[0]->getTextures()[0];
+		}
+
+		double BloomPostProcessor::getGPUTime(Mode mode) const
+		{
+			return mode == Mode::GAUSSIAN ? gaussianTimer.getAverage() : mipChainTimer.getAverage();
+		}
+
+		BloomPostProcessor::Mode BloomPostProcessor::getMode() const
+		{
+			return mode;
+		}
+
+		float BloomPostProcessor::getScale() const
+		{
+			return scale;
+		}
+
+		bool BloomPostProcessor::isCombinedDispatch() const
+		{
+			return combinedDispatch;
+		}
+
+		bool BloomPostProcessor::isComputeEnabled() const
+		{
+			return computeEnabled;
+		}
+
+		bool BloomPostProcessor::isComputeUsed() const
+		{
+			return mode == Mode::GAUSSIAN && computeEnabled && OpenGLComputeProgram::isSupported();
+		}
+
+		void BloomPostProcessor::logGPUTimes() const
+		{
+			Logs::info("simplicity::opengl",
+					"Bloom GPU time: Gaussian %.3fms (%u frames), mip chain %.3fms (%u frames)",
+					gaussianTimer.getAverage(), gaussianTimer.getSampleCount(), mipChainTimer.getAverage(),
+					mipChainTimer.getSampleCount());
+		}
+
+		void BloomPostProcessor::process(RenderingEngine& engine)
+		{
+			OpenGLRenderingEngine& openGLEngine = static_cast<OpenGLRenderingEngine&>(engine);
+			process(openGLEngine, openGLEngine.getFrameBuffer()->getTextures()[0], nullptr);
+		}
+
+		void BloomPostProcessor::process(OpenGLRenderingEngine& engine, const shared_ptr<Texture>& source,
+				FrameBuffer* target)
+		{
+			OpenGLTimer& timer = mode == Mode::GAUSSIAN ? gaussianTimer : mipChainTimer;
+
+			timer.begin();
+
+			acquireTargets(engine);
+
+			shared_ptr<Texture> bloom;
+			if (isComputeUsed())
+			{
+				bloom = blurGaussianCompute(engine);
+			}
+			else if (mode == Mode::GAUSSIAN)
+			{
+				bloom = blurGaussian(engine);
+			}
+			else
+			{
+				bloom = blurMipChain(engine);
+			}
+
+			blend(engine, source, *bloom, target);
+
+			// The blur targets are only needed for this frame, they go back to the pool to be shared with the other
+			// effects.
+			releaseTargets();
+
+			timer.end();
+		}
+
+		void BloomPostProcessor::releaseTargets()
+		{
+			OpenGLRenderTargetPool::release(move(pingFrameBuffer));
+			OpenGLRenderTargetPool::release(move(pongFrameBuffer));
+
+			for (unique_ptr<FrameBuffer>& level : mipChain)
+			{
+				OpenGLRenderTargetPool::release(move(level));
+			}
+			mipChain.clear();
+		}
+
+		void BloomPostProcessor::setCombinedDispatch(bool combinedDispatch)
+		{
+			this->combinedDispatch = combinedDispatch;
+		}
+
+		void BloomPostProcessor::setComputeEnabled(bool computeEnabled)
+		{
+			this->computeEnabled = computeEnabled;
+		}
+
+		void BloomPostProcessor::setMode(Mode mode)
+		{
+			this->mode = mode;
+		}
+
+		void BloomPostProcessor::setScale(float scale)
+		{
+			this->scale = scale;
 		}
 	}
 }
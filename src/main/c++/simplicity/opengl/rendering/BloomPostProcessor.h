@@ -12,30 +12,187 @@
 #ifndef BLOOMPOSTPROCESSOR_H
 #define BLOOMPOSTPROCESSOR_H
 
-#include <simplicity/model/Model.h>
 #include <simplicity/rendering/PostProcessor.h>
 
+#include "../common/OpenGLTimer.h"
+#include "OpenGLComputeProgram.h"
+#include "OpenGLPostEffect.h"
+#include "OpenGLRenderState.h"
 #include "OpenGLRenderingEngine.h"
 
 namespace simplicity
 {
 	namespace opengl
 	{
-		class BloomPostProcessor :public PostProcessor
+		/**
+		 * <p>
+		 * Blurs the bloom output of the scene (the second color attachment of the engine's frame buffer) and blends
+		 * it over the scene.
+		 * </p>
+		 *
+		 * <p>
+		 * The mip chain mode filters the bloom output down through a chain of half resolution targets and back up
+		 * again, adding each level onto the one above it. It gives a wider blur than the Gaussian mode for a fraction
+		 * of the fill rate and bandwidth. The GPU time of each mode is measured so they can be compared.
+		 * </p>
+		 *
+		 * <p>
+		 * It can be used on its own as the engine's post processor or as an effect in an OpenGLPostProcessingChain.
+		 * </p>
+		 */
+		class BloomPostProcessor : public PostProcessor, public OpenGLPostEffect
 		{
 			public:
-				BloomPostProcessor();
+				/**
+				 * <p>
+				 * How the bloom output is blurred.
+				 * </p>
+				 */
+				enum class Mode
+				{
+					/**
+					 * <p>
+					 * Five horizontal and vertical Gaussian passes. Done with compute shaders when they are available
+					 * (OpenGL 4.3), otherwise by drawing full screen triangles.
+					 * </p>
+					 */
+					GAUSSIAN,
+
+					/**
+					 * <p>
+					 * A 13 tap downsample through a chain of half resolution targets followed by a tent filtered
+					 * upsample back up it.
+					 * </p>
+					 */
+					MIP_CHAIN
+				};
+
+				/**
+				 * @param mode How the bloom output is blurred.
+				 * @param scale The size of the blur targets relative to the engine (e.g. 0.5 for half resolution).
+				 */
+				BloomPostProcessor(Mode mode = Mode::MIP_CHAIN, float scale = 1.0f);
+
+				/**
+				 * @param mode The mode to retrieve the GPU time of.
+				 *
+				 * @return The average GPU time in milliseconds spent by the mode per frame so far.
+				 */
+				double getGPUTime(Mode mode) const;
+
+				Mode getMode() const;
+
+				/**
+				 * @return The size of the blur targets relative to the engine.
+				 */
+				float getScale() const;
+
+				/**
+				 * @return True if the Gaussian blur does both directions in one compute dispatch, false otherwise.
+				 */
+				bool isCombinedDispatch() const;
+
+				/**
+				 * @return True if the Gaussian blur uses compute shaders when they are available, false otherwise.
+				 */
+				bool isComputeEnabled() const;
+
+				/**
+				 * <p>
+				 * Logs the average GPU times of both modes for comparison.
+				 * </p>
+				 */
+				void logGPUTimes() const;
 
 				void process(RenderingEngine& engine) override;
 
+				void process(OpenGLRenderingEngine& engine, const std::shared_ptr<Texture>& source,
+						FrameBuffer* target) override;
+
+				/**
+				 * <p>
+				 * Sets whether the compute Gaussian blur does both directions in one dispatch (through a 2D tile in
+				 * shared memory) instead of one dispatch per direction.
+				 * </p>
+				 *
+				 * @param combinedDispatch True to blur both directions in one dispatch.
+				 */
+				void setCombinedDispatch(bool combinedDispatch);
+
+				/**
+				 * <p>
+				 * Sets whether the Gaussian blur uses compute shaders when they are available.
+				 * </p>
+				 *
+				 * @param computeEnabled True to use compute shaders when they are available.
+				 */
+				void setComputeEnabled(bool computeEnabled);
+
+				void setMode(Mode mode);
+
+				/**
+				 * <p>
+				 * Sets the size of the blur targets relative to the engine (e.g. 0.5 for half resolution). The targets
+				 * are resized on the next frame.
+				 * </p>
+				 *
+				 * @param scale The size of the blur targets relative to the engine.
+				 */
+				void setScale(float scale);
+
 			private:
+				static const unsigned int MIP_CHAIN_LEVELS = 6;
+
+				std::shared_ptr<Pipeline> blendPipeline;
+
+				std::unique_ptr<OpenGLComputeProgram> blurProgram;
+
+				bool combinedDispatch;
+
+				std::unique_ptr<OpenGLComputeProgram> combinedBlurProgram;
+
+				bool computeEnabled;
+
+				std::shared_ptr<Pipeline> downsamplePipeline;
+
+				std::shared_ptr<const OpenGLRenderState> downsampleRenderState;
+
+				std::shared_ptr<Pipeline> gaussianPipeline;
+
+				OpenGLTimer gaussianTimer;
+
+				std::vector<std::unique_ptr<FrameBuffer>> mipChain;
+
+				OpenGLTimer mipChainTimer;
+
+				Mode mode;
+
 				std::unique_ptr<FrameBuffer> pingFrameBuffer;
 
 				std::unique_ptr<FrameBuffer> pongFrameBuffer;
 
-				std::unique_ptr<Model> quad;
+				std::shared_ptr<const OpenGLRenderState> renderState;
+
+				float scale;
+
+				std::shared_ptr<Pipeline> upsamplePipeline;
+
+				std::shared_ptr<const OpenGLRenderState> upsampleRenderState;
+
+				void acquireTargets(const OpenGLRenderingEngine& engine);
+
+				void blend(OpenGLRenderingEngine& engine, const std::shared_ptr<Texture>& source, const Texture& bloom,
+						FrameBuffer* target);
+
+				std::shared_ptr<Texture> blurGaussian(OpenGLRenderingEngine& engine);
+
+				std::shared_ptr<Texture> blurGaussianCompute(OpenGLRenderingEngine& engine);
+
+				std::shared_ptr<Texture> blurMipChain(OpenGLRenderingEngine& engine);
+
+				bool isComputeUsed() const;
 
-				OpenGLRenderingEngine::RenderList renderList;
+				void releaseTargets();
 		};
 	}
 }
@@ -21,6 +21,7 @@
 #include "../common/OpenGL.h"
 #include "../model/OpenGLMeshBuffer.h"
 #include "MultiDrawOpenGLRenderer.h"
+#include "OpenGLPipeline.h"
 
 using namespace std;
 
@@ -47,6 +48,8 @@ namespace simplicity
 				return;
 			}
 
+			static_cast<OpenGLPipeline*>(getDefaultPipeline())->flush();
+
 			if (buffer.isIndexed())
 			{
 				glMultiDrawElementsBaseVertex(
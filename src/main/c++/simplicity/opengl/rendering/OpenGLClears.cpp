@@ -0,0 +1,120 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include "../common/OpenGL.h"
+#include "OpenGLClears.h"
+#include "OpenGLRenderState.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace OpenGLClears
+		{
+			namespace
+			{
+				GLbitfield buffers = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+
+				Vector4 color(0.0f, 0.0f, 0.0f, 0.0f);
+
+				GLbitfield issued = 0;
+
+				GLbitfield pending = 0;
+
+				Statistics statistics;
+			}
+
+			void begin(GLbitfield mask, GLbitfield buffers)
+			{
+				OpenGLClears::buffers = buffers;
+				color = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+				issued = 0;
+				pending = mask & buffers;
+			}
+
+			void flush()
+			{
+				if (pending == 0)
+				{
+					return;
+				}
+
+				if ((pending & GL_COLOR_BUFFER_BIT) != 0)
+				{
+					glClearColor(color.X(), color.Y(), color.Z(), color.W());
+					OpenGL::checkError();
+				}
+
+				// Masked writes and the scissor test would leave parts of the buffers uncleared, the state is set up
+				// through the shadow and put back afterwards so the next render state applied is not misled.
+				bool scissorTestForced = OpenGLRenderState::isScissorTestForced();
+				OpenGLRenderState::setScissorTestForced(false);
+				OpenGLRenderState::Description previous = OpenGLRenderState::getCurrent();
+				OpenGLRenderState::Description clearable = previous;
+				clearable.colorWrite = true;
+				clearable.depthWrite = true;
+				clearable.scissorTest = false;
+				OpenGLRenderState(clearable).apply();
+
+				glClear(pending);
+				OpenGL::checkError();
+
+				OpenGLRenderState(previous).apply();
+				OpenGLRenderState::setScissorTestForced(scissorTestForced);
+
+				issued |= pending;
+				pending = 0;
+				statistics.clears++;
+			}
+
+			Statistics getStatistics()
+			{
+				return statistics;
+			}
+
+			void request(GLbitfield mask, const Vector4& color)
+			{
+				mask &= buffers;
+				if (mask == 0)
+				{
+					return;
+				}
+
+				// Buffers already cleared for this target fold into that clear, so it is cleared once however many
+				// renderers ask.
+				if (pending != 0 || (mask & issued) != 0)
+				{
+					statistics.merges++;
+				}
+
+				mask &= ~issued;
+				if (mask == 0)
+				{
+					return;
+				}
+
+				if ((mask & GL_COLOR_BUFFER_BIT) != 0)
+				{
+					OpenGLClears::color = color;
+				}
+
+				pending |= mask;
+			}
+
+			void suppress(GLbitfield mask)
+			{
+				pending &= ~mask;
+			}
+		}
+	}
+}
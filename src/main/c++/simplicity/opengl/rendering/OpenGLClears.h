@@ -0,0 +1,99 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLCLEARS_H_
+#define OPENGLCLEARS_H_
+
+#include <GL/glew.h>
+
+#include <simplicity/common/Defines.h>
+#include <simplicity/math/Vector.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Merges the clears requested for the bound target into a single glClear. The frame graph begins a target
+		 * with the clear its pass needs, renderers then add buffers to it or suppress them (see
+		 * AbstractOpenGLRenderer) and the clear is issued when flushed, just before drawing. Each buffer is cleared at
+		 * most once per target, requests for buffers that have already been cleared fold into that clear. Buffers the
+		 * target does not have (e.g. stencil on a frame buffer without one) are never cleared.
+		 * </p>
+		 */
+		namespace OpenGLClears
+		{
+			/**
+			 * <p>
+			 * A count of the clears requested and issued.
+			 * </p>
+			 */
+			struct SIMPLE_API Statistics
+			{
+				/**
+				 * <p>
+				 * The number of glClear calls issued.
+				 * </p>
+				 */
+				unsigned int clears = 0;
+
+				/**
+				 * <p>
+				 * The number of requests merged into a clear that was already pending or issued.
+				 * </p>
+				 */
+				unsigned int merges = 0;
+			};
+
+			/**
+			 * <p>
+			 * Starts tracking clears for a newly bound target. The previous target's clear must have been flushed.
+			 * </p>
+			 *
+			 * @param mask The buffers to clear (GL_COLOR_BUFFER_BIT etc.), 0 for none.
+			 * @param buffers The buffers the target has.
+			 */
+			SIMPLE_API void begin(GLbitfield mask, GLbitfield buffers);
+
+			/**
+			 * <p>
+			 * Issues the pending clear, if there is one. Color and depth writes are enabled and the scissor test is
+			 * disabled for the clear, the render state applied before it is restored afterwards.
+			 * </p>
+			 */
+			SIMPLE_API void flush();
+
+			SIMPLE_API Statistics getStatistics();
+
+			/**
+			 * <p>
+			 * Adds buffers to the pending clear. Buffers already cleared since the target began are not cleared again.
+			 * </p>
+			 *
+			 * @param mask The buffers to clear.
+			 * @param color The color to clear the color buffer to.
+			 */
+			SIMPLE_API void request(GLbitfield mask, const Vector4& color);
+
+			/**
+			 * <p>
+			 * Removes buffers from the pending clear, so their contents are kept.
+			 * </p>
+			 *
+			 * @param mask The buffers not to clear.
+			 */
+			SIMPLE_API void suppress(GLbitfield mask);
+		}
+	}
+}
+
+#endif /* OPENGLCLEARS_H_ */
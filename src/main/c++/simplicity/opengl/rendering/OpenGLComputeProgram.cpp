@@ -0,0 +1,200 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <chrono>
+
+#include <simplicity/logging/Logs.h>
+
+#include "../common/OpenGL.h"
+#include "OpenGLComputeProgram.h"
+#include "OpenGLPipeline.h"
+#include "OpenGLProgramCache.h"
+#include "OpenGLShader.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		OpenGLComputeProgram::OpenGLComputeProgram(const string& source) :
+			initialized(false),
+			parameters(),
+			program(0),
+			source(source),
+			valid(false)
+		{
+		}
+
+		OpenGLComputeProgram::~OpenGLComputeProgram()
+		{
+			if (program != 0)
+			{
+				glDeleteProgram(program);
+				OpenGL::checkError();
+			}
+		}
+
+		void OpenGLComputeProgram::apply()
+		{
+			// Initialization needs to occur after OpenGL is initialized, this might not have happened when the
+			// constructor is called.
+			if (!initialized)
+			{
+				init();
+			}
+
+			glUseProgram(program);
+			OpenGL::checkError();
+			OpenGLPipeline::resetApplied();
+		}
+
+		void OpenGLComputeProgram::dispatch(unsigned int x, unsigned int y, unsigned int z)
+		{
+			if (!valid)
+			{
+				return;
+			}
+
+			parameters.flush();
+
+			glDispatchCompute(x, y, z);
+			OpenGL::checkError();
+		}
+
+		const OpenGLParameterBlock& OpenGLComputeProgram::getParameters() const
+		{
+			return parameters;
+		}
+
+		void OpenGLComputeProgram::init()
+		{
+			program = glCreateProgram();
+			initialized = true;
+
+			parameters.setDeclaredNames(OpenGLShader::getUniformNames(source));
+
+			uint64_t cacheKey = 0;
+			if (OpenGLProgramCache::isEnabled())
+			{
+				cacheKey = OpenGLProgramCache::createKey({ source });
+				if (OpenGLProgramCache::load(cacheKey, program))
+				{
+					parameters.reflect(program);
+					valid = true;
+					return;
+				}
+			}
+
+			chrono::steady_clock::time_point compileStart = chrono::steady_clock::now();
+
+			// Contexts older than 4.3 can still run compute shaders through the extensions.
+			string compiledSource = source;
+			if (!GLEW_VERSION_4_3 && compiledSource.compare(0, 12, "#version 430") == 0)
+			{
+				compiledSource.replace(0, 12, "#version 420\n"
+						"#extension GL_ARB_compute_shader : require\n"
+						"#extension GL_ARB_shader_image_size : require");
+			}
+
+			GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+			OpenGL::checkError();
+			const char* sourceData = compiledSource.data();
+			glShaderSource(shader, 1, &sourceData, nullptr);
+			OpenGL::checkError();
+			glCompileShader(shader);
+			OpenGL::checkError();
+
+			GLint compileStatus;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+			OpenGL::checkError();
+
+			if (compileStatus == 0)
+			{
+				GLchar infoLog[1024];
+				glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+				OpenGL::checkError();
+
+				Logs::error("simplicity::opengl", "Error compiling compute shader:");
+				Logs::error("simplicity::opengl", infoLog);
+
+				glDeleteShader(shader);
+				OpenGL::checkError();
+				return;
+			}
+
+			glAttachShader(program, shader);
+			OpenGL::checkError();
+
+			if (OpenGLProgramCache::isEnabled())
+			{
+				glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+				OpenGL::checkError();
+			}
+
+			glLinkProgram(program);
+			OpenGL::checkError();
+
+			// The program keeps what it needs, the shader is only flagged for deletion until it is detached.
+			glDetachShader(program, shader);
+			OpenGL::checkError();
+			glDeleteShader(shader);
+			OpenGL::checkError();
+
+			GLint linkStatus;
+			glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+			OpenGL::checkError();
+
+			if (linkStatus == 0)
+			{
+				GLchar infoLog[1024];
+				glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
+				OpenGL::checkError();
+
+				Logs::error("simplicity::opengl", "Error linking compute program:");
+				Logs::error("simplicity::opengl", infoLog);
+				return;
+			}
+
+			if (OpenGLProgramCache::isEnabled())
+			{
+				OpenGLProgramCache::recordCompileTime(
+						chrono::duration<double, milli>(chrono::steady_clock::now() - compileStart).count());
+				OpenGLProgramCache::store(cacheKey, program);
+			}
+
+			parameters.reflect(program);
+			valid = true;
+		}
+
+		bool OpenGLComputeProgram::isSupported()
+		{
+			// The built in programs also need image load/store (4.2) and imageSize().
+			return GLEW_VERSION_4_3 ||
+					(GLEW_VERSION_4_2 && GLEW_ARB_compute_shader && GLEW_ARB_shader_image_size);
+		}
+
+		bool OpenGLComputeProgram::isValid() const
+		{
+			return valid;
+		}
+
+		void OpenGLComputeProgram::set(const string& name, float value)
+		{
+			parameters.set(name, GL_FLOAT, &value, sizeof(value));
+		}
+
+		void OpenGLComputeProgram::set(const string& name, int value)
+		{
+			parameters.set(name, GL_INT, &value, sizeof(value));
+		}
+	}
+}
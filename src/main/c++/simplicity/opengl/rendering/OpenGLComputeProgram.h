@@ -0,0 +1,98 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLCOMPUTEPROGRAM_H_
+#define OPENGLCOMPUTEPROGRAM_H_
+
+#include <string>
+
+#include <GL/glew.h>
+
+#include "OpenGLParameterBlock.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * A program made of a single compute shader (OpenGL 4.3). Compute programs sit outside of the rendering
+		 * pipeline so they read and write textures directly (as samplers and images bound to units declared in the
+		 * shader) rather than drawing into frame buffers.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLComputeProgram
+		{
+			public:
+				/**
+				 * @param source The source of the compute shader.
+				 */
+				OpenGLComputeProgram(const std::string& source);
+
+				~OpenGLComputeProgram();
+
+				OpenGLComputeProgram(const OpenGLComputeProgram& original) = delete;
+
+				OpenGLComputeProgram& operator=(const OpenGLComputeProgram& original) = delete;
+
+				/**
+				 * <p>
+				 * Makes this the current program, compiling and linking it the first time.
+				 * </p>
+				 */
+				void apply();
+
+				/**
+				 * <p>
+				 * Uploads any parameters that have changed and launches work groups. The program must have been
+				 * applied.
+				 * </p>
+				 *
+				 * @param x The number of work groups in the x dimension.
+				 * @param y The number of work groups in the y dimension.
+				 * @param z The number of work groups in the z dimension.
+				 */
+				void dispatch(unsigned int x, unsigned int y, unsigned int z = 1);
+
+				const OpenGLParameterBlock& getParameters() const;
+
+				/**
+				 * @return True if the program compiled and linked, false otherwise.
+				 */
+				bool isValid() const;
+
+				/**
+				 * @return True if compute shaders are available (OpenGL 4.3, or 4.2 with GL_ARB_compute_shader), false
+				 * otherwise.
+				 */
+				static bool isSupported();
+
+				void set(const std::string& name, float value);
+
+				void set(const std::string& name, int value);
+
+			private:
+				bool initialized;
+
+				OpenGLParameterBlock parameters;
+
+				GLuint program;
+
+				std::string source;
+
+				bool valid;
+
+				void init();
+		};
+	}
+}
+
+#endif /* OPENGLCOMPUTEPROGRAM_H_ */
@@ -11,12 +11,82 @@ namespace simplicity
 	namespace opengl
 	{
 		OpenGLFrameBuffer::OpenGLFrameBuffer(const vector<shared_ptr<Texture>>& textures, bool hasDepth) :
+			OpenGLFrameBuffer(textures, hasDepth ? DepthFormat::DEPTH : DepthFormat::NONE)
+		{
+		}
+
+		OpenGLFrameBuffer::OpenGLFrameBuffer(const vector<shared_ptr<Texture>>& textures, DepthFormat depthFormat,
+				bool depthTexture, unsigned int samples) :
+			colorBufferNames(),
 			depthBufferName(0),
-			hasDepth(hasDepth),
+			depthFormat(depthFormat),
+			depthTexture(),
 			initialized(false),
 			name(0),
+			resolveName(0),
+			samples(samples == 0 ? 1 : samples),
 			textures(textures)
 		{
+			if (depthTexture && depthFormat != DepthFormat::NONE)
+			{
+				this->depthTexture = OpenGLTexture::createDepthTexture(textures[0]->getWidth(),
+						textures[0]->getHeight(), getOpenGLDepthFormat());
+			}
+		}
+
+		OpenGLFrameBuffer::~OpenGLFrameBuffer()
+		{
+			if (!colorBufferNames.empty())
+			{
+				glDeleteRenderbuffers(static_cast<GLsizei>(colorBufferNames.size()), colorBufferNames.data());
+				OpenGL::checkError();
+			}
+
+			if (depthBufferName != 0)
+			{
+				glDeleteRenderbuffers(1, &depthBufferName);
+				OpenGL::checkError();
+			}
+
+			if (name != 0)
+			{
+				glDeleteFramebuffers(1, &name);
+				OpenGL::checkError();
+			}
+
+			if (resolveName != 0)
+			{
+				glDeleteFramebuffers(1, &resolveName);
+				OpenGL::checkError();
+			}
+		}
+
+		void OpenGLFrameBuffer::allocateRenderBuffers(unsigned int width, unsigned int height)
+		{
+			for (unsigned int index = 0; index < colorBufferNames.size(); index++)
+			{
+				glBindRenderbuffer(GL_RENDERBUFFER, colorBufferNames[index]);
+				OpenGL::checkError();
+				glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples,
+						static_pointer_cast<OpenGLTexture>(textures[index])->getOpenGLInternalPixelFormat(), width,
+						height);
+				OpenGL::checkError();
+			}
+
+			if (depthBufferName != 0)
+			{
+				glBindRenderbuffer(GL_RENDERBUFFER, depthBufferName);
+				OpenGL::checkError();
+				if (samples > 1)
+				{
+					glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, getOpenGLDepthFormat(), width, height);
+				}
+				else
+				{
+					glRenderbufferStorage(GL_RENDERBUFFER, getOpenGLDepthFormat(), width, height);
+				}
+				OpenGL::checkError();
+			}
 		}
 
 		void OpenGLFrameBuffer::apply()
@@ -34,6 +104,75 @@ namespace simplicity
 			OpenGL::checkError();
 		}
 
+		void OpenGLFrameBuffer::attachTextures()
+		{
+			if (depthTexture != nullptr)
+			{
+				// Sampleable depth so later passes can read it without a copy.
+				depthTexture->apply();
+				glFramebufferTexture(GL_FRAMEBUFFER, getDepthAttachment(), depthTexture->getTexture(), 0);
+				OpenGL::checkError();
+			}
+
+			// Bind the textures as destinations for the colors to be written to.
+			vector<GLenum> drawBuffers;
+			for (unsigned int index = 0; index < textures.size(); index++)
+			{
+				textures[index]->apply();
+				glFramebufferTexture(GL_FRAMEBUFFER,
+									 GL_COLOR_ATTACHMENT0 + index,
+									 static_pointer_cast<OpenGLTexture>(textures[index])->getTexture(),
+									 0);
+				OpenGL::checkError();
+
+				drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + index);
+			}
+
+			// Draw to all the textures.
+			glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+			OpenGL::checkError();
+		}
+
+		GLenum OpenGLFrameBuffer::getDepthAttachment() const
+		{
+			if (depthFormat == DepthFormat::DEPTH24_STENCIL8)
+			{
+				return GL_DEPTH_STENCIL_ATTACHMENT;
+			}
+
+			return GL_DEPTH_ATTACHMENT;
+		}
+
+		OpenGLFrameBuffer::DepthFormat OpenGLFrameBuffer::getDepthFormat() const
+		{
+			return depthFormat;
+		}
+
+		shared_ptr<Texture> OpenGLFrameBuffer::getDepthTexture() const
+		{
+			return depthTexture;
+		}
+
+		GLenum OpenGLFrameBuffer::getOpenGLDepthFormat() const
+		{
+			if (depthFormat == DepthFormat::DEPTH24_STENCIL8)
+			{
+				return GL_DEPTH24_STENCIL8;
+			}
+
+			if (depthFormat == DepthFormat::DEPTH32F)
+			{
+				return GL_DEPTH_COMPONENT32F;
+			}
+
+			return GL_DEPTH_COMPONENT;
+		}
+
+		unsigned int OpenGLFrameBuffer::getSamples() const
+		{
+			return samples;
+		}
+
 		vector<shared_ptr<Texture>>& OpenGLFrameBuffer::getTextures()
 		{
 			return textures;
@@ -41,41 +180,69 @@ namespace simplicity
 
 		void OpenGLFrameBuffer::init()
 		{
+			if (samples > 1)
+			{
+				GLint maxSamples = 1;
+				glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+				OpenGL::checkError();
+
+				if (samples > static_cast<unsigned int>(maxSamples))
+				{
+					Logs::warning("simplicity::opengl", "%u samples requested but only %i are supported", samples,
+							maxSamples);
+					samples = maxSamples;
+				}
+			}
+
 			glGenFramebuffers(1, &name);
 			OpenGL::checkError();
 			glBindFramebuffer(GL_FRAMEBUFFER, name);
 			OpenGL::checkError();
 
-			if (hasDepth)
+			if (depthFormat != DepthFormat::NONE && (depthTexture == nullptr || samples > 1))
 			{
 				glGenRenderbuffers(1, &depthBufferName);
 				OpenGL::checkError();
-				glBindRenderbuffer(GL_RENDERBUFFER, depthBufferName);
-				OpenGL::checkError();
-				glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, textures[0]->getWidth(),
-									  textures[0]->getHeight());
+			}
+
+			if (samples > 1)
+			{
+				// Draw into multisampled render buffers, the textures only ever receive the resolved result.
+				colorBufferNames.resize(textures.size());
+				glGenRenderbuffers(static_cast<GLsizei>(colorBufferNames.size()), colorBufferNames.data());
 				OpenGL::checkError();
-				glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBufferName);
+			}
+
+			allocateRenderBuffers(textures[0]->getWidth(), textures[0]->getHeight());
+
+			if (depthBufferName != 0)
+			{
+				glFramebufferRenderbuffer(GL_FRAMEBUFFER, getDepthAttachment(), GL_RENDERBUFFER, depthBufferName);
 				OpenGL::checkError();
 			}
 
-			// Bind the textures as destinations for the colors to be written to.
-			vector<GLenum> drawBuffers;
-			for (unsigned int index = 0; index < textures.size(); index++)
+			if (samples > 1)
 			{
-				textures[index]->apply();
-				glFramebufferTexture(GL_FRAMEBUFFER,
-									 GL_COLOR_ATTACHMENT0 + index,
-									 static_pointer_cast<OpenGLTexture>(textures[index])->getTexture(),
-									 0);
+				vector<GLenum> drawBuffers;
+				for (unsigned int index = 0; index < colorBufferNames.size(); index++)
+				{
+					glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + index, GL_RENDERBUFFER,
+							colorBufferNames[index]);
+					OpenGL::checkError();
+
+					drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + index);
+				}
+
+				glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
 				OpenGL::checkError();
 
-				drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + index);
+				glGenFramebuffers(1, &resolveName);
+				OpenGL::checkError();
+				glBindFramebuffer(GL_FRAMEBUFFER, resolveName);
+				OpenGL::checkError();
 			}
 
-			// Draw to all the textures.
-			glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
-			OpenGL::checkError();
+			attachTextures();
 
 			auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 			if (status == GL_FRAMEBUFFER_UNSUPPORTED)
@@ -89,5 +256,133 @@ namespace simplicity
 
 			initialized = true;
 		}
+
+		void OpenGLFrameBuffer::invalidate(bool colors, bool depthStencil)
+		{
+			if (!isInvalidateSupported() || !initialized)
+			{
+				return;
+			}
+
+			vector<GLenum> attachments;
+			if (colors)
+			{
+				for (unsigned int index = 0; index < textures.size(); index++)
+				{
+					attachments.push_back(GL_COLOR_ATTACHMENT0 + index);
+				}
+			}
+
+			if (depthStencil && depthFormat != DepthFormat::NONE)
+			{
+				attachments.push_back(getDepthAttachment());
+			}
+
+			if (attachments.empty())
+			{
+				return;
+			}
+
+			glBindFramebuffer(GL_FRAMEBUFFER, name);
+			OpenGL::checkError();
+			glInvalidateFramebuffer(GL_FRAMEBUFFER, static_cast<GLsizei>(attachments.size()), attachments.data());
+			OpenGL::checkError();
+		}
+
+		void OpenGLFrameBuffer::invalidateDefault(bool colors, bool depthStencil)
+		{
+			if (!isInvalidateSupported())
+			{
+				return;
+			}
+
+			vector<GLenum> attachments;
+			if (colors)
+			{
+				attachments.push_back(GL_COLOR);
+			}
+
+			if (depthStencil)
+			{
+				attachments.push_back(GL_DEPTH);
+				attachments.push_back(GL_STENCIL);
+			}
+
+			if (attachments.empty())
+			{
+				return;
+			}
+
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			OpenGL::checkError();
+			glInvalidateFramebuffer(GL_FRAMEBUFFER, static_cast<GLsizei>(attachments.size()), attachments.data());
+			OpenGL::checkError();
+		}
+
+		bool OpenGLFrameBuffer::isInitialized() const
+		{
+			return initialized;
+		}
+
+		bool OpenGLFrameBuffer::isInvalidateSupported()
+		{
+			return GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata;
+		}
+
+		void OpenGLFrameBuffer::resize(unsigned int width, unsigned int height)
+		{
+			for (shared_ptr<Texture>& texture : textures)
+			{
+				static_pointer_cast<OpenGLTexture>(texture)->resize(width, height);
+			}
+
+			if (depthTexture != nullptr)
+			{
+				depthTexture->resize(width, height);
+			}
+
+			allocateRenderBuffers(width, height);
+		}
+
+		void OpenGLFrameBuffer::resolve()
+		{
+			if (samples == 1 || !initialized)
+			{
+				return;
+			}
+
+			GLint width = textures[0]->getWidth();
+			GLint height = textures[0]->getHeight();
+
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, name);
+			OpenGL::checkError();
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveName);
+			OpenGL::checkError();
+
+			// Blits only copy one color buffer at a time, so each attachment is resolved in turn.
+			for (unsigned int index = 0; index < textures.size(); index++)
+			{
+				glReadBuffer(GL_COLOR_ATTACHMENT0 + index);
+				OpenGL::checkError();
+				glDrawBuffer(GL_COLOR_ATTACHMENT0 + index);
+				OpenGL::checkError();
+
+				GLbitfield mask = GL_COLOR_BUFFER_BIT;
+				if (index == 0 && depthTexture != nullptr)
+				{
+					mask |= GL_DEPTH_BUFFER_BIT;
+					if (depthFormat == DepthFormat::DEPTH24_STENCIL8)
+					{
+						mask |= GL_STENCIL_BUFFER_BIT;
+					}
+				}
+
+				glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, mask, GL_NEAREST);
+				OpenGL::checkError();
+			}
+
+			glBindFramebuffer(GL_FRAMEBUFFER, name);
+			OpenGL::checkError();
+		}
 	}
 }
@@ -5,6 +5,8 @@
 
 #include <simplicity/rendering/FrameBuffer.h>
 
+#include "OpenGLTexture.h"
+
 namespace simplicity
 {
 	namespace opengl
@@ -12,24 +14,155 @@ namespace simplicity
 		class SIMPLE_API OpenGLFrameBuffer : public FrameBuffer
 		{
 			public:
+				/**
+				 * <p>
+				 * The format of a frame buffer's depth (and stencil) buffer.
+				 * </p>
+				 */
+				enum class DepthFormat
+				{
+					/**
+					 * <p>
+					 * Whatever depth format the driver picks, with no stencil.
+					 * </p>
+					 */
+					DEPTH,
+
+					/**
+					 * <p>
+					 * 24 bit depth with 8 bit stencil.
+					 * </p>
+					 */
+					DEPTH24_STENCIL8,
+
+					/**
+					 * <p>
+					 * 32 bit floating point depth with no stencil.
+					 * </p>
+					 */
+					DEPTH32F,
+
+					/**
+					 * <p>
+					 * No depth buffer.
+					 * </p>
+					 */
+					NONE
+				};
+
 				OpenGLFrameBuffer(const std::vector<std::shared_ptr<Texture>>& textures, bool hasDepth);
 
+				/**
+				 * @param textures The textures to draw colors into.
+				 * @param depthFormat The format of the depth buffer.
+				 * @param depthTexture Determines whether the depth buffer is a texture that can be sampled (see
+				 * getDepthTexture()) rather than a render buffer.
+				 * @param samples The number of samples per pixel. When more than one, drawing goes into multisampled
+				 * render buffers and resolve() copies the result into the textures.
+				 */
+				OpenGLFrameBuffer(const std::vector<std::shared_ptr<Texture>>& textures, DepthFormat depthFormat,
+						bool depthTexture = false, unsigned int samples = 1);
+
+				~OpenGLFrameBuffer();
+
 				void apply() override;
 
+				DepthFormat getDepthFormat() const;
+
+				/**
+				 * @return The depth buffer, if it was created as a texture, nullptr otherwise.
+				 */
+				std::shared_ptr<Texture> getDepthTexture() const;
+
+				/**
+				 * @return The number of samples per pixel, this can be less than requested if the driver does not
+				 * support that many.
+				 */
+				unsigned int getSamples() const;
+
 				std::vector<std::shared_ptr<Texture>>& getTextures() override;
 
 				void init();
 
+				/**
+				 * <p>
+				 * Tells the driver the contents of some attachments are not needed anymore, so tiled and bandwidth
+				 * limited GPUs can skip writing them back to memory at the end of a pass (or reading them back in at
+				 * the start of one). With multiple samples this applies to the multisampled attachments, e.g. once
+				 * they have been resolved. This binds the frame buffer. Does nothing if framebuffer invalidation is
+				 * not supported (OpenGL 4.3 or ARB_invalidate_subdata).
+				 * </p>
+				 *
+				 * @param colors Determines whether the color attachments are invalidated.
+				 * @param depthStencil Determines whether the depth and stencil attachments are invalidated.
+				 */
+				void invalidate(bool colors, bool depthStencil);
+
+				/**
+				 * <p>
+				 * Does the same as invalidate() for the default frame buffer.
+				 * </p>
+				 *
+				 * @param colors Determines whether the color buffer is invalidated.
+				 * @param depthStencil Determines whether the depth and stencil buffers are invalidated.
+				 */
+				static void invalidateDefault(bool colors, bool depthStencil);
+
+				/**
+				 * @return True if the frame buffer has been created, false otherwise.
+				 */
+				bool isInitialized() const;
+
+				/**
+				 * @return True if framebuffer invalidation is supported, false otherwise.
+				 */
+				static bool isInvalidateSupported();
+
+				/**
+				 * <p>
+				 * Copies the multisampled colors (and depth, if it is a texture) into the textures with
+				 * glBlitFramebuffer. This binds the frame buffer. Does nothing if there is only one sample.
+				 * </p>
+				 */
+				void resolve();
+
+				/**
+				 * <p>
+				 * Reallocates the textures and depth buffer at a new size without recreating any OpenGL objects. The
+				 * contents are discarded.
+				 * </p>
+				 *
+				 * @param width The new width.
+				 * @param height The new height.
+				 */
+				void resize(unsigned int width, unsigned int height);
+
 			private:
+				std::vector<GLuint> colorBufferNames;
+
 				GLuint depthBufferName;
 
-				bool hasDepth;
+				DepthFormat depthFormat;
+
+				std::shared_ptr<OpenGLTexture> depthTexture;
 
 				bool initialized;
 
 				GLuint name;
 
+				GLuint resolveName;
+
+				unsigned int samples;
+
 				std::vector<std::shared_ptr<Texture>> textures;
+
+				void allocateRenderBuffers(unsigned int width, unsigned int height);
+
+				void attachTextures();
+
+				GLenum getDepthAttachment() const;
+
+				GLenum getOpenGLDepthFormat() const;
 		};
 	}
 }
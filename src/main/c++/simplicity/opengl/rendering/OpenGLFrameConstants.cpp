@@ -0,0 +1,189 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include <simplicity/logging/Logs.h>
+
+#include "../common/OpenGL.h"
+#include "../common/OpenGLFence.h"
+#include "../common/PersistentlyMappedOpenGLBuffer.h"
+#include "../common/SimpleOpenGLBuffer.h"
+#include "OpenGLFrameConstants.h"
+#include "OpenGLPipeline.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace OpenGLFrameConstants
+		{
+			const string BLOCK_NAME = "FrameConstants";
+
+			namespace
+			{
+				// Enough for the GPU to be a couple of frames behind the CPU without making it wait.
+				const unsigned int FRAME_COUNT = 3;
+
+				const unsigned int BLOCKS_PER_FRAME = 16;
+
+				unsigned int blockSize = 0;
+
+				unique_ptr<OpenGLBuffer> buffer;
+
+				Constants constants;
+
+				unsigned int currentBlock = 0;
+
+				unsigned int currentFrame = 0;
+
+				// Set when the current block has not been written to yet this frame.
+				bool dirty = true;
+
+				unique_ptr<OpenGLFence> fences[FRAME_COUNT];
+
+				bool overflowReported = false;
+
+				bool persistent = false;
+
+				// Offsets in the Constants struct by name.
+				const struct
+				{
+					const char* name;
+
+					size_t offset;
+				} MATRIX_CONSTANTS[] =
+				{
+					{ "cameraTransform", offsetof(Constants, cameraTransform) }
+				};
+
+				void init()
+				{
+					GLint alignment = OpenGLPipeline::getUniformBufferOffsetAlignment();
+					blockSize = ((sizeof(Constants) + alignment - 1) / alignment) * alignment;
+
+					unsigned int size = blockSize * BLOCKS_PER_FRAME * FRAME_COUNT;
+					persistent = GLEW_ARB_buffer_storage;
+					if (persistent)
+					{
+						buffer.reset(new PersistentlyMappedOpenGLBuffer(Buffer::DataType::SHADER_DATA, size));
+					}
+					else
+					{
+						buffer.reset(new SimpleOpenGLBuffer(Buffer::DataType::SHADER_DATA, size, nullptr,
+								Buffer::AccessHint::WRITE));
+					}
+				}
+
+				void write()
+				{
+					if (buffer == nullptr)
+					{
+						init();
+					}
+
+					// The current block may already have been drawn with so the new value needs a block of its own.
+					if (!dirty)
+					{
+						if (currentBlock + 1 < BLOCKS_PER_FRAME)
+						{
+							currentBlock++;
+						}
+						else if (!overflowReported)
+						{
+							Logs::warning("simplicity::opengl",
+									"More than %u frame constant changes in a frame, overwriting the last block.",
+									BLOCKS_PER_FRAME);
+							overflowReported = true;
+						}
+					}
+
+					unsigned int offset = (currentFrame * BLOCKS_PER_FRAME + currentBlock) * blockSize;
+					if (persistent)
+					{
+						memcpy(buffer->getData(false) + offset, &constants, sizeof(Constants));
+					}
+					else
+					{
+						glBindBuffer(GL_UNIFORM_BUFFER, buffer->getName());
+						OpenGL::checkError();
+						glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(Constants), &constants);
+						OpenGL::checkError();
+					}
+
+					OpenGLPipeline::bindUniformBuffer(BLOCK_NAME, *buffer, offset, sizeof(Constants));
+					dirty = false;
+				}
+			}
+
+			void dispose()
+			{
+				for (unique_ptr<OpenGLFence>& fence : fences)
+				{
+					fence.reset();
+				}
+
+				buffer.reset();
+				dirty = true;
+			}
+
+			void nextFrame()
+			{
+				if (buffer == nullptr)
+				{
+					return;
+				}
+
+				fences[currentFrame].reset(new OpenGLFence);
+
+				currentFrame = (currentFrame + 1) % FRAME_COUNT;
+				currentBlock = 0;
+
+				// Nothing has been drawn with block 0 of this frame yet, so write() must not move past it.
+				dirty = true;
+
+				if (fences[currentFrame] != nullptr)
+				{
+					fences[currentFrame]->wait();
+					fences[currentFrame].reset();
+				}
+
+				// The constants carry over but they need writing into this frame's region before they are used.
+				write();
+			}
+
+			bool set(const string& name, const Matrix44& value)
+			{
+				for (const auto& constant : MATRIX_CONSTANTS)
+				{
+					if (name == constant.name)
+					{
+						Matrix44* member = reinterpret_cast<Matrix44*>(reinterpret_cast<char*>(&constants) +
+								constant.offset);
+						if (buffer == nullptr || memcmp(member->getData(), value.getData(), sizeof(float) * 16) != 0)
+						{
+							*member = value;
+							write();
+						}
+
+						return true;
+					}
+				}
+
+				return false;
+			}
+		}
+	}
+}
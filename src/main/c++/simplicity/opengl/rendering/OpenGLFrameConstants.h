@@ -0,0 +1,85 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLFRAMECONSTANTS_H_
+#define OPENGLFRAMECONSTANTS_H_
+
+#include <string>
+
+#include <simplicity/math/Matrix.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Holds the shader data that is the same for every pipeline in a frame (e.g. the camera transform) in a std140
+		 * uniform block named FrameConstants. The data is written once into a persistently mapped ring buffer and
+		 * bound with a single glBindBufferRange, so switching pipelines does not upload it again.
+		 * </p>
+		 *
+		 * <p>
+		 * Each frame has its own region of the ring, protected by a fence so that the CPU never writes over data the
+		 * GPU has yet to read. If a constant changes part way through a frame (e.g. a second camera) the next block in
+		 * the frame's region is used.
+		 * </p>
+		 */
+		namespace OpenGLFrameConstants
+		{
+			/**
+			 * <p>
+			 * The layout of the FrameConstants block. Members must follow the std140 rules.
+			 * </p>
+			 */
+			struct Constants
+			{
+				Matrix44 cameraTransform;
+			};
+
+			/**
+			 * <p>
+			 * The name of the uniform block in shaders.
+			 * </p>
+			 */
+			extern SIMPLE_API const std::string BLOCK_NAME;
+
+			/**
+			 * <p>
+			 * Releases the ring buffer.
+			 * </p>
+			 */
+			SIMPLE_API void dispose();
+
+			/**
+			 * <p>
+			 * Moves on to the next frame's region of the ring, waiting for the GPU to finish with it if necessary.
+			 * Should be called once at the start of each frame.
+			 * </p>
+			 */
+			SIMPLE_API void nextFrame();
+
+			/**
+			 * <p>
+			 * Sets a frame constant. Setting a constant to the value it already has does nothing.
+			 * </p>
+			 *
+			 * @param name The name of the constant (the name of the member in the FrameConstants block).
+			 * @param value The value.
+			 *
+			 * @return True if name is a frame constant, false otherwise.
+			 */
+			SIMPLE_API bool set(const std::string& name, const Matrix44& value);
+		}
+	}
+}
+
+#endif /* OPENGLFRAMECONSTANTS_H_ */
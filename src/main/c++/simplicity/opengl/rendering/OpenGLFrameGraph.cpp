@@ -0,0 +1,633 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <algorithm>
+#include <set>
+
+#include <GL/glew.h>
+
+#include <simplicity/logging/Logs.h>
+
+#include "../common/Hash.h"
+#include "../common/OpenGL.h"
+#include "OpenGLClears.h"
+#include "OpenGLFrameBuffer.h"
+#include "OpenGLFrameGraph.h"
+#include "OpenGLRenderTargetPool.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace
+		{
+			bool contains(const vector<OpenGLFrameGraph::Target>& targets, OpenGLFrameGraph::Target target)
+			{
+				return find(targets.begin(), targets.end(), target) != targets.end();
+			}
+
+			// The buffers a clear of the frame buffer can touch.
+			GLbitfield getBuffers(FrameBuffer* frameBuffer)
+			{
+				GLbitfield buffers = GL_COLOR_BUFFER_BIT;
+				if (frameBuffer == nullptr)
+				{
+					// The default frame buffer's format is fixed when the window is created, it must be bound.
+					static GLbitfield defaultBuffers = 0;
+					if (defaultBuffers == 0)
+					{
+						defaultBuffers = buffers;
+
+						GLint type = GL_NONE;
+						glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_DEPTH,
+								GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+						OpenGL::checkError();
+						if (type != GL_NONE)
+						{
+							defaultBuffers |= GL_DEPTH_BUFFER_BIT;
+						}
+
+						glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_STENCIL,
+								GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+						OpenGL::checkError();
+						if (type != GL_NONE)
+						{
+							defaultBuffers |= GL_STENCIL_BUFFER_BIT;
+						}
+					}
+
+					return defaultBuffers;
+				}
+
+				OpenGLFrameBuffer::DepthFormat depthFormat =
+						static_cast<OpenGLFrameBuffer*>(frameBuffer)->getDepthFormat();
+				if (depthFormat != OpenGLFrameBuffer::DepthFormat::NONE)
+				{
+					buffers |= GL_DEPTH_BUFFER_BIT;
+				}
+				if (depthFormat == OpenGLFrameBuffer::DepthFormat::DEPTH24_STENCIL8)
+				{
+					buffers |= GL_STENCIL_BUFFER_BIT;
+				}
+
+				return buffers;
+			}
+
+			// Tells the driver the contents of the frame buffer are not needed, so tiled GPUs can skip loading them
+			// before a pass or storing them after it.
+			void invalidate(FrameBuffer* frameBuffer, bool colors, bool depthStencil)
+			{
+				if (frameBuffer == nullptr)
+				{
+					OpenGLFrameBuffer::invalidateDefault(colors, depthStencil);
+				}
+				else
+				{
+					static_cast<OpenGLFrameBuffer*>(frameBuffer)->invalidate(colors, depthStencil);
+				}
+			}
+		}
+
+		const OpenGLFrameGraph::Target OpenGLFrameGraph::NO_TARGET = static_cast<Target>(-1);
+
+		OpenGLFrameGraph::OpenGLFrameGraph() :
+			compiledKey(0),
+			culledPasses(),
+			nextStep(0),
+			passes(),
+			pendingPass(false),
+			schedule(),
+			statistics(),
+			targets(),
+			transients()
+		{
+		}
+
+		void OpenGLFrameGraph::addPass(const string& name, const vector<Target>& reads, Target write,
+				function<void()> execute, bool clear)
+		{
+			Pass pass;
+			pass.clear = clear;
+			pass.execute = execute;
+			pass.name = name;
+			pass.reads = reads;
+			pass.write = write;
+
+			passes.push_back(pass);
+		}
+
+		void OpenGLFrameGraph::addRead(const string& pass, Target read)
+		{
+			for (Pass& declared : passes)
+			{
+				if (declared.name == pass)
+				{
+					declared.reads.push_back(read);
+					return;
+				}
+			}
+
+			Logs::error("simplicity::opengl", "Frame graph has no pass named %s to add a read to", pass.data());
+		}
+
+		void OpenGLFrameGraph::beginStep(const Step& step)
+		{
+			const Pass& pass = passes[step.pass];
+
+			for (Target target : step.acquires)
+			{
+				const TargetDescription& description = targets[target].description;
+				transients[target] = OpenGLRenderTargetPool::acquire(description.width, description.height,
+						description.format, description.hasDepth);
+			}
+
+			if (pass.write == NO_TARGET)
+			{
+				return;
+			}
+
+			FrameBuffer* frameBuffer = getFrameBuffer(pass.write);
+			if (frameBuffer == nullptr)
+			{
+				glBindFramebuffer(GL_FRAMEBUFFER, 0);
+				OpenGL::checkError();
+				glViewport(0, 0, targets[pass.write].description.width, targets[pass.write].description.height);
+				OpenGL::checkError();
+			}
+			else
+			{
+				frameBuffer->apply();
+			}
+
+			// Issued once the renderers have had their say, or at the end of the pass if nothing draws.
+			GLbitfield clearMask = 0;
+			if (step.loadAction == LoadAction::CLEAR)
+			{
+				clearMask = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+			}
+			OpenGLClears::begin(clearMask, getBuffers(frameBuffer));
+
+			if (step.loadAction == LoadAction::DONT_CARE)
+			{
+				invalidate(frameBuffer, true, true);
+			}
+		}
+
+		void OpenGLFrameGraph::clear()
+		{
+			passes.clear();
+			targets.clear();
+		}
+
+		void OpenGLFrameGraph::compile()
+		{
+			culledPasses.clear();
+			schedule.clear();
+			transients.clear();
+			transients.resize(targets.size());
+
+			vector<unsigned int> order = getOrder();
+
+			// Walk back from the outputs, a pass is needed if something needed reads what it writes. Passes run by
+			// the caller are always needed, the caller draws them whether they contribute to an output or not.
+			vector<bool> needed(targets.size(), false);
+			for (unsigned int target = 0; target < targets.size(); target++)
+			{
+				needed[target] = targets[target].output;
+			}
+
+			vector<bool> live(passes.size(), false);
+			for (auto index = order.rbegin(); index != order.rend(); index++)
+			{
+				const Pass& pass = passes[*index];
+				if (pass.write == NO_TARGET || needed[pass.write] || !pass.execute)
+				{
+					live[*index] = true;
+					for (Target read : pass.reads)
+					{
+						needed[read] = true;
+					}
+				}
+			}
+
+			vector<bool> written(targets.size(), false);
+			vector<int> firstUses(targets.size(), -1);
+			vector<int> lastReads(targets.size(), -1);
+			vector<int> lastUses(targets.size(), -1);
+			for (unsigned int index : order)
+			{
+				const Pass& pass = passes[index];
+				if (!live[index])
+				{
+					culledPasses.push_back(pass.name);
+					continue;
+				}
+
+				Step step;
+				step.discard = false;
+				step.discardDepth = false;
+				step.loadAction = LoadAction::LOAD;
+				step.pass = index;
+
+				int stepIndex = static_cast<int>(schedule.size());
+				vector<Target> uses = pass.reads;
+				if (pass.write != NO_TARGET)
+				{
+					uses.push_back(pass.write);
+
+					if (pass.clear)
+					{
+						step.loadAction = LoadAction::CLEAR;
+					}
+					else if (!written[pass.write] && !targets[pass.write].imported && !contains(pass.reads, pass.write))
+					{
+						step.loadAction = LoadAction::DONT_CARE;
+					}
+
+					written[pass.write] = true;
+				}
+
+				for (Target use : uses)
+				{
+					if (firstUses[use] == -1)
+					{
+						firstUses[use] = stepIndex;
+					}
+					lastUses[use] = stepIndex;
+				}
+
+				for (Target read : pass.reads)
+				{
+					if (!written[read] && !targets[read].imported)
+					{
+						Logs::warning("simplicity::opengl", "Frame graph pass %s reads target %s before it is written",
+								pass.name.data(), targets[read].name.data());
+					}
+					lastReads[read] = stepIndex;
+				}
+
+				schedule.push_back(step);
+			}
+
+			for (unsigned int target = 0; target < targets.size(); target++)
+			{
+				if (targets[target].imported || firstUses[target] == -1)
+				{
+					continue;
+				}
+
+				schedule[firstUses[target]].acquires.push_back(target);
+				schedule[lastUses[target]].releases.push_back(target);
+			}
+
+			// Transient contents that nothing reads after the pass that wrote them need not be stored.
+			for (Step& step : schedule)
+			{
+				Target write = passes[step.pass].write;
+				if (write != NO_TARGET && !targets[write].imported &&
+						lastReads[write] <= static_cast<int>(&step - schedule.data()))
+				{
+					step.discard = true;
+				}
+			}
+
+			// Depth is only needed by passes that draw into the same target, so it need not be stored after the last
+			// of them. Imported targets keep it if their first pass loads it, it could be read again next frame.
+			vector<bool> depthLoaded(targets.size(), false);
+			vector<bool> depthWritten(targets.size(), false);
+			for (const Step& step : schedule)
+			{
+				Target write = passes[step.pass].write;
+				if (write != NO_TARGET && !depthWritten[write])
+				{
+					depthLoaded[write] = targets[write].imported && step.loadAction == LoadAction::LOAD;
+					depthWritten[write] = true;
+				}
+			}
+
+			vector<bool> depthNeeded(targets.size(), false);
+			for (auto step = schedule.rbegin(); step != schedule.rend(); step++)
+			{
+				Target write = passes[step->pass].write;
+				if (write == NO_TARGET)
+				{
+					continue;
+				}
+
+				if (!depthNeeded[write] && !depthLoaded[write])
+				{
+					step->discardDepth = true;
+				}
+				depthNeeded[write] = true;
+			}
+
+			statistics.compiles++;
+			statistics.culledPasses = static_cast<unsigned int>(culledPasses.size());
+		}
+
+		OpenGLFrameGraph::Target OpenGLFrameGraph::createTarget(const string& name,
+				const TargetDescription& description)
+		{
+			TargetDeclaration declaration;
+			declaration.description = description;
+			declaration.frameBuffer = nullptr;
+			declaration.imported = false;
+			declaration.name = name;
+			declaration.output = false;
+
+			targets.push_back(declaration);
+
+			return static_cast<Target>(targets.size() - 1);
+		}
+
+		void OpenGLFrameGraph::endStep(const Step& step)
+		{
+			OpenGLClears::flush();
+
+			Target write = passes[step.pass].write;
+			if (write != NO_TARGET)
+			{
+				FrameBuffer* frameBuffer = getFrameBuffer(write);
+				OpenGLFrameBuffer* openGLFrameBuffer = static_cast<OpenGLFrameBuffer*>(frameBuffer);
+
+				// Later passes (and whoever reads the outputs) sample the textures, not the multisampled buffers.
+				bool resolved = false;
+				if (openGLFrameBuffer != nullptr && openGLFrameBuffer->getSamples() > 1 && !step.discard)
+				{
+					openGLFrameBuffer->resolve();
+					resolved = true;
+				}
+
+				if (step.discard || step.discardDepth)
+				{
+					// Nothing reads the multisampled buffers once they are resolved. Otherwise sampleable depth may
+					// be read by later passes so it is kept.
+					bool depthTexture = !resolved && openGLFrameBuffer != nullptr &&
+							openGLFrameBuffer->getDepthTexture() != nullptr;
+
+					invalidate(frameBuffer, step.discard || resolved, step.discard || !depthTexture);
+				}
+			}
+
+			for (Target target : step.releases)
+			{
+				OpenGLRenderTargetPool::release(move(transients[target]));
+			}
+		}
+
+		bool OpenGLFrameGraph::execute()
+		{
+			if (pendingPass)
+			{
+				endStep(schedule[nextStep]);
+				nextStep++;
+				pendingPass = false;
+			}
+			else if (nextStep == 0)
+			{
+				uint64_t key = getStructureKey();
+				if (key == compiledKey)
+				{
+					statistics.reuses++;
+				}
+				else
+				{
+					compile();
+					compiledKey = key;
+				}
+			}
+
+			while (nextStep < schedule.size())
+			{
+				const Step& step = schedule[nextStep];
+				beginStep(step);
+
+				const Pass& pass = passes[step.pass];
+				if (!pass.execute)
+				{
+					pendingPass = true;
+					return true;
+				}
+
+				pass.execute();
+
+				endStep(step);
+				nextStep++;
+			}
+
+			nextStep = 0;
+
+			return false;
+		}
+
+		FrameBuffer* OpenGLFrameGraph::getFrameBuffer(Target target) const
+		{
+			if (targets[target].imported)
+			{
+				return targets[target].frameBuffer;
+			}
+
+			return transients[target].get();
+		}
+
+		vector<unsigned int> OpenGLFrameGraph::getOrder() const
+		{
+			// A pass depends on the writers of what it reads. Readers use the writers declared before them if there
+			// are any (later writers must then wait for the reader), and writers of the same target keep the order
+			// they were declared in.
+			vector<set<unsigned int>> dependents(passes.size());
+			vector<unsigned int> dependencyCounts(passes.size(), 0);
+			auto addDependency = [&](unsigned int dependency, unsigned int dependent)
+			{
+				if (dependents[dependency].insert(dependent).second)
+				{
+					dependencyCounts[dependent]++;
+				}
+			};
+
+			for (unsigned int reader = 0; reader < passes.size(); reader++)
+			{
+				for (Target read : passes[reader].reads)
+				{
+					bool earlierWriter = false;
+					for (unsigned int writer = 0; writer < reader; writer++)
+					{
+						earlierWriter = earlierWriter || passes[writer].write == read;
+					}
+
+					for (unsigned int writer = 0; writer < passes.size(); writer++)
+					{
+						if (writer == reader || passes[writer].write != read)
+						{
+							continue;
+						}
+
+						if (writer < reader || !earlierWriter)
+						{
+							addDependency(writer, reader);
+						}
+						else
+						{
+							addDependency(reader, writer);
+						}
+					}
+				}
+			}
+
+			for (unsigned int writer = 0; writer < passes.size(); writer++)
+			{
+				for (unsigned int laterWriter = writer + 1; laterWriter < passes.size(); laterWriter++)
+				{
+					if (passes[writer].write != NO_TARGET && passes[writer].write == passes[laterWriter].write)
+					{
+						addDependency(writer, laterWriter);
+					}
+				}
+			}
+
+			// Passes that are ready run in the order they were declared.
+			set<unsigned int> ready;
+			for (unsigned int pass = 0; pass < passes.size(); pass++)
+			{
+				if (dependencyCounts[pass] == 0)
+				{
+					ready.insert(pass);
+				}
+			}
+
+			vector<unsigned int> order;
+			while (!ready.empty())
+			{
+				unsigned int pass = *ready.begin();
+				ready.erase(ready.begin());
+				order.push_back(pass);
+
+				for (unsigned int dependent : dependents[pass])
+				{
+					if (--dependencyCounts[dependent] == 0)
+					{
+						ready.insert(dependent);
+					}
+				}
+			}
+
+			if (order.size() != passes.size())
+			{
+				Logs::error("simplicity::opengl", "Frame graph has a cycle, running passes in the order declared");
+
+				order.clear();
+				for (unsigned int pass = 0; pass < passes.size(); pass++)
+				{
+					order.push_back(pass);
+				}
+			}
+
+			return order;
+		}
+
+		const OpenGLFrameGraph::Statistics& OpenGLFrameGraph::getStatistics() const
+		{
+			return statistics;
+		}
+
+		uint64_t OpenGLFrameGraph::getStructureKey() const
+		{
+			// Everything compile() depends on, the execute functions are looked up again each frame.
+			string structure;
+			for (const TargetDeclaration& target : targets)
+			{
+				structure += target.name + "|" + to_string(target.imported) + to_string(target.output) + "|" +
+						to_string(reinterpret_cast<uintptr_t>(target.frameBuffer)) + "|" +
+						to_string(static_cast<int>(target.description.format)) +
+						to_string(target.description.hasDepth) + "|" + to_string(target.description.width) + "x" +
+						to_string(target.description.height) + ";";
+			}
+
+			for (const Pass& pass : passes)
+			{
+				structure += pass.name + "|" + to_string(pass.clear) + to_string(!pass.execute) + "|";
+				for (Target read : pass.reads)
+				{
+					structure += to_string(read) + ",";
+				}
+				structure += "|" + to_string(pass.write) + ";";
+			}
+
+			return Hash::fnv1a(structure);
+		}
+
+		OpenGLFrameGraph::Target OpenGLFrameGraph::getTarget(const string& name) const
+		{
+			for (unsigned int target = 0; target < targets.size(); target++)
+			{
+				if (targets[target].name == name)
+				{
+					return target;
+				}
+			}
+
+			return NO_TARGET;
+		}
+
+		OpenGLFrameGraph::Target OpenGLFrameGraph::importTarget(const string& name, FrameBuffer* frameBuffer,
+				const TargetDescription& description, bool output)
+		{
+			TargetDeclaration declaration;
+			declaration.description = description;
+			declaration.frameBuffer = frameBuffer;
+			declaration.imported = true;
+			declaration.name = name;
+			declaration.output = output;
+
+			targets.push_back(declaration);
+
+			return static_cast<Target>(targets.size() - 1);
+		}
+
+		void OpenGLFrameGraph::logSchedule() const
+		{
+			for (const Step& step : schedule)
+			{
+				const Pass& pass = passes[step.pass];
+				const char* target = pass.write == NO_TARGET ? "none" : targets[pass.write].name.data();
+				const char* loadAction = step.loadAction == LoadAction::CLEAR ? "clear" :
+						step.loadAction == LoadAction::DONT_CARE ? "don't care" : "load";
+
+				const char* storeAction = step.discard ? "discard" : step.discardDepth ? "store color" : "store";
+
+				Logs::info("simplicity::opengl", "Frame graph pass %s: target %s, %s, %s", pass.name.data(), target,
+						loadAction, storeAction);
+			}
+
+			for (const string& culledPass : culledPasses)
+			{
+				Logs::info("simplicity::opengl", "Frame graph pass %s: culled", culledPass.data());
+			}
+		}
+
+		OpenGLFrameGraph::Statistics::Statistics() :
+			compiles(0),
+			culledPasses(0),
+			reuses(0)
+		{
+		}
+
+		OpenGLFrameGraph::TargetDescription::TargetDescription() :
+			format(PixelFormat::RGBA),
+			hasDepth(false),
+			height(0),
+			width(0)
+		{
+		}
+	}
+}
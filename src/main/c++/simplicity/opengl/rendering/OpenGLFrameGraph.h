@@ -0,0 +1,302 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLFRAMEGRAPH_H_
+#define OPENGLFRAMEGRAPH_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <simplicity/rendering/FrameBuffer.h>
+#include <simplicity/rendering/PixelFormat.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Schedules the passes of a frame from the render targets (frame buffers) each of them reads and writes. The
+		 * passes and targets are declared up front and the graph is then compiled:
+		 * </p>
+		 *
+		 * <ul>
+		 * <li>Passes that contribute nothing to an output target are culled.</li>
+		 * <li>The remaining passes are ordered so that each one runs after the passes that write what it reads.</li>
+		 * <li>Each pass' target is cleared, loaded or invalidated (its contents are not needed) before the pass runs,
+		 * and invalidated after the pass if nothing reads it afterwards. Depth and stencil are invalidated after the
+		 * last pass that draws into the target.</li>
+		 * <li>Multisampled targets are resolved into their textures after each pass that draws into them.</li>
+		 * <li>Transient targets are acquired from the OpenGLRenderTargetPool just before their first use and released
+		 * straight after their last, so targets that are not needed at the same time share memory.</li>
+		 * </ul>
+		 *
+		 * <p>
+		 * Passes are declared again every frame (after a call to clear()). If they have the same structure as the
+		 * last frame's the compiled schedule is reused.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLFrameGraph
+		{
+			public:
+				/**
+				 * <p>
+				 * Identifies a target within the graph.
+				 * </p>
+				 */
+				typedef unsigned int Target;
+
+				/**
+				 * <p>
+				 * The size and format of a target.
+				 * </p>
+				 */
+				struct SIMPLE_API TargetDescription
+				{
+					TargetDescription();
+
+					PixelFormat format;
+
+					bool hasDepth;
+
+					unsigned int height;
+
+					unsigned int width;
+				};
+
+				/**
+				 * <p>
+				 * Compilation statistics.
+				 * </p>
+				 */
+				struct SIMPLE_API Statistics
+				{
+					Statistics();
+
+					unsigned int compiles;
+
+					/**
+					 * <p>
+					 * The number of passes culled by the last compile.
+					 * </p>
+					 */
+					unsigned int culledPasses;
+
+					/**
+					 * <p>
+					 * The number of frames that reused the compiled schedule of the frame before.
+					 * </p>
+					 */
+					unsigned int reuses;
+				};
+
+				/**
+				 * <p>
+				 * Used instead of a target for passes that do not draw into one.
+				 * </p>
+				 */
+				static const Target NO_TARGET;
+
+				OpenGLFrameGraph();
+
+				/**
+				 * <p>
+				 * Declares a pass.
+				 * </p>
+				 *
+				 * @param name The name of the pass.
+				 * @param reads The targets the pass reads from.
+				 * @param write The target the pass draws into, NO_TARGET if it does not draw into one.
+				 * @param execute Runs the pass once its target has been bound. If it is empty the pass is run by the
+				 * caller of execute(), see execute(). Such passes are never culled since the caller draws them anyway.
+				 * @param clear Determines whether the target is cleared before the pass runs.
+				 */
+				void addPass(const std::string& name, const std::vector<Target>& reads, Target write,
+						std::function<void()> execute, bool clear = false);
+
+				/**
+				 * <p>
+				 * Adds a read to a pass that has already been declared, e.g. to make a pass declared by someone else
+				 * wait for a target written by a pass declared later.
+				 * </p>
+				 *
+				 * @param pass The name of the pass.
+				 * @param read The target the pass reads from.
+				 */
+				void addRead(const std::string& pass, Target read);
+
+				/**
+				 * <p>
+				 * Removes all the declared passes and targets, ready to declare the next frame's.
+				 * </p>
+				 */
+				void clear();
+
+				/**
+				 * <p>
+				 * Declares a target owned by the graph. Its frame buffer is only available while the passes that use it
+				 * are running.
+				 * </p>
+				 *
+				 * @param name The name of the target.
+				 * @param description The size and format of the target.
+				 *
+				 * @return The target.
+				 */
+				Target createTarget(const std::string& name, const TargetDescription& description);
+
+				/**
+				 * <p>
+				 * Runs the passes in their scheduled order, compiling the graph first if needed.
+				 * </p>
+				 *
+				 * <p>
+				 * When it reaches a pass without an execute function it binds the pass' target and returns, leaving
+				 * the caller to draw. Calling execute() again finishes the pass and carries on with the next one.
+				 * </p>
+				 *
+				 * @return True if it stopped at a pass for the caller to run, false if all the passes have been run.
+				 */
+				bool execute();
+
+				/**
+				 * <p>
+				 * Retrieves the frame buffer of a target. For transient targets this is only valid while the passes
+				 * that use it are running.
+				 * </p>
+				 *
+				 * @param target The target.
+				 *
+				 * @return The frame buffer, nullptr for the default frame buffer.
+				 */
+				FrameBuffer* getFrameBuffer(Target target) const;
+
+				const Statistics& getStatistics() const;
+
+				/**
+				 * <p>
+				 * Retrieves a target by name.
+				 * </p>
+				 *
+				 * @param name The name of the target.
+				 *
+				 * @return The target or NO_TARGET if there is no target with the given name.
+				 */
+				Target getTarget(const std::string& name) const;
+
+				/**
+				 * <p>
+				 * Declares a target that is owned elsewhere, its contents are kept between frames.
+				 * </p>
+				 *
+				 * @param name The name of the target.
+				 * @param frameBuffer The frame buffer, nullptr for the default frame buffer.
+				 * @param description The size and format of the target.
+				 * @param output Determines whether the target is an output of the frame. Only passes that contribute to
+				 * an output are run.
+				 *
+				 * @return The target.
+				 */
+				Target importTarget(const std::string& name, FrameBuffer* frameBuffer,
+						const TargetDescription& description, bool output = false);
+
+				/**
+				 * <p>
+				 * Logs the compiled schedule: the order of the passes, their load and store actions and the culled
+				 * passes.
+				 * </p>
+				 */
+				void logSchedule() const;
+
+			private:
+				enum class LoadAction
+				{
+					CLEAR,
+					DONT_CARE,
+					LOAD
+				};
+
+				struct Pass
+				{
+					bool clear;
+
+					std::function<void()> execute;
+
+					std::string name;
+
+					std::vector<Target> reads;
+
+					Target write;
+				};
+
+				struct Step
+				{
+					std::vector<Target> acquires;
+
+					bool discard;
+
+					bool discardDepth;
+
+					LoadAction loadAction;
+
+					unsigned int pass;
+
+					std::vector<Target> releases;
+				};
+
+				struct TargetDeclaration
+				{
+					TargetDescription description;
+
+					FrameBuffer* frameBuffer;
+
+					bool imported;
+
+					std::string name;
+
+					bool output;
+				};
+
+				std::uint64_t compiledKey;
+
+				std::vector<std::string> culledPasses;
+
+				unsigned int nextStep;
+
+				std::vector<Pass> passes;
+
+				bool pendingPass;
+
+				std::vector<Step> schedule;
+
+				Statistics statistics;
+
+				std::vector<TargetDeclaration> targets;
+
+				std::vector<std::unique_ptr<FrameBuffer>> transients;
+
+				void beginStep(const Step& step);
+
+				void compile();
+
+				void endStep(const Step& step);
+
+				std::vector<unsigned int> getOrder() const;
+
+				std::uint64_t getStructureKey() const;
+		};
+	}
+}
+
+#endif /* OPENGLFRAMEGRAPH_H_ */
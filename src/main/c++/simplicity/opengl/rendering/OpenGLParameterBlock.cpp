@@ -0,0 +1,270 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <cstring>
+
+#include <simplicity/logging/Logs.h>
+
+#include "../common/OpenGL.h"
+#include "OpenGLParameterBlock.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		OpenGLParameterBlock::OpenGLParameterBlock() :
+			declaredNames(),
+			dirtyValues(),
+			reportedNames(),
+			statistics(),
+			values()
+		{
+		}
+
+		void OpenGLParameterBlock::flush()
+		{
+			for (Value* value : dirtyValues)
+			{
+				value->dirty = false;
+
+				// It may have been set back to the value the program already holds.
+				if (value->uploaded == value->staged)
+				{
+					continue;
+				}
+
+				upload(*value);
+				value->uploaded = value->staged;
+				statistics.uploads++;
+			}
+
+			dirtyValues.clear();
+		}
+
+		const OpenGLParameterBlock::Parameter* OpenGLParameterBlock::getParameter(const string& name) const
+		{
+			auto value = values.find(name);
+			if (value == values.end())
+			{
+				return nullptr;
+			}
+
+			return &value->second.parameter;
+		}
+
+		vector<const OpenGLParameterBlock::Parameter*> OpenGLParameterBlock::getParameters() const
+		{
+			vector<const Parameter*> parameters;
+			for (const pair<const string, Value>& value : values)
+			{
+				parameters.push_back(&value.second.parameter);
+			}
+
+			return parameters;
+		}
+
+		const OpenGLParameterBlock::Statistics& OpenGLParameterBlock::getStatistics() const
+		{
+			return statistics;
+		}
+
+		void OpenGLParameterBlock::invalidate()
+		{
+			for (pair<const string, Value>& value : values)
+			{
+				value.second.uploaded.clear();
+
+				if (!value.second.dirty && !value.second.staged.empty())
+				{
+					value.second.dirty = true;
+					dirtyValues.push_back(&value.second);
+				}
+			}
+		}
+
+		bool OpenGLParameterBlock::isCompatible(GLenum parameterType, GLenum valueType) const
+		{
+			if (parameterType == valueType)
+			{
+				return true;
+			}
+
+			return valueType == GL_INT && (parameterType == GL_BOOL || isSampler(parameterType));
+		}
+
+		bool OpenGLParameterBlock::isSampler(GLenum type)
+		{
+			switch (type)
+			{
+				case GL_SAMPLER_1D:
+				case GL_SAMPLER_2D:
+				case GL_SAMPLER_2D_ARRAY:
+				case GL_SAMPLER_2D_MULTISAMPLE:
+				case GL_SAMPLER_2D_SHADOW:
+				case GL_SAMPLER_3D:
+				case GL_SAMPLER_BUFFER:
+				case GL_SAMPLER_CUBE:
+				case GL_SAMPLER_CUBE_MAP_ARRAY:
+				case GL_INT_SAMPLER_2D:
+				case GL_UNSIGNED_INT_SAMPLER_2D:
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		void OpenGLParameterBlock::reflect(GLuint program)
+		{
+			// Values staged for the previous program (if any) are carried over to the new one.
+			map<string, Value> previousValues;
+			previousValues.swap(values);
+			dirtyValues.clear();
+
+			GLint uniformCount = 0;
+			glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+			OpenGL::checkError();
+
+			for (GLint index = 0; index < uniformCount; index++)
+			{
+				GLchar name[256];
+				Value value;
+				glGetActiveUniform(program, index, sizeof(name), nullptr, &value.parameter.count,
+						&value.parameter.type, name);
+				OpenGL::checkError();
+
+				value.parameter.location = glGetUniformLocation(program, name);
+				OpenGL::checkError();
+
+				// Uniforms in blocks have no location, they are set through buffers.
+				if (value.parameter.location == -1)
+				{
+					continue;
+				}
+
+				// Arrays are reported as 'name[0]' but are set by 'name'.
+				value.parameter.name = name;
+				size_t subscript = value.parameter.name.rfind("[0]");
+				if (subscript != string::npos && subscript == value.parameter.name.size() - 3)
+				{
+					value.parameter.name.erase(subscript);
+				}
+
+				value.dirty = false;
+				Value& newValue = values[value.parameter.name];
+				newValue = value;
+
+				auto previous = previousValues.find(value.parameter.name);
+				if (previous != previousValues.end() && previous->second.parameter.type == value.parameter.type &&
+						!previous->second.staged.empty())
+				{
+					newValue.staged = previous->second.staged;
+					newValue.dirty = true;
+					dirtyValues.push_back(&newValue);
+				}
+			}
+		}
+
+		void OpenGLParameterBlock::report(const string& name, const string& message)
+		{
+			if (reportedNames.insert(name).second)
+			{
+				Logs::error("simplicity::opengl", "%s: %s", name.data(), message.data());
+			}
+		}
+
+		void OpenGLParameterBlock::set(const string& name, GLenum type, const void* data, unsigned int size)
+		{
+			auto found = values.find(name);
+			if (found == values.end())
+			{
+				// Uniforms the compiler optimized away are not worth reporting, shader variants routinely drop some.
+				// Members of structs and elements of arrays are declared under the name of the whole uniform.
+				if (declaredNames.find(name.substr(0, name.find_first_of(".["))) == declaredNames.end())
+				{
+					report(name, "No such uniform is active in the program.");
+				}
+				return;
+			}
+
+			Value& value = found->second;
+			if (!isCompatible(value.parameter.type, type))
+			{
+				report(name, "The uniform is not of the type of the value set.");
+				return;
+			}
+
+			if (value.staged.size() == size && memcmp(value.staged.data(), data, size) == 0)
+			{
+				statistics.redundantSets++;
+				return;
+			}
+
+			value.staged.assign(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+			if (!value.dirty)
+			{
+				value.dirty = true;
+				dirtyValues.push_back(&value);
+			}
+		}
+
+		void OpenGLParameterBlock::setDeclaredNames(const std::set<string>& declaredNames)
+		{
+			this->declaredNames = declaredNames;
+		}
+
+		void OpenGLParameterBlock::upload(const Value& value) const
+		{
+			GLint location = value.parameter.location;
+			const GLfloat* floats = reinterpret_cast<const GLfloat*>(value.staged.data());
+			const GLint* ints = reinterpret_cast<const GLint*>(value.staged.data());
+
+			switch (value.parameter.type)
+			{
+				case GL_FLOAT:
+					glUniform1fv(location, value.staged.size() / sizeof(GLfloat), floats);
+					break;
+				case GL_FLOAT_VEC2:
+					glUniform2fv(location, value.staged.size() / (sizeof(GLfloat) * 2), floats);
+					break;
+				case GL_FLOAT_VEC3:
+					glUniform3fv(location, value.staged.size() / (sizeof(GLfloat) * 3), floats);
+					break;
+				case GL_FLOAT_VEC4:
+					glUniform4fv(location, value.staged.size() / (sizeof(GLfloat) * 4), floats);
+					break;
+				case GL_FLOAT_MAT4:
+					glUniformMatrix4fv(location, value.staged.size() / (sizeof(GLfloat) * 16), GL_FALSE, floats);
+					break;
+				default:
+					// Integers, booleans and samplers.
+					glUniform1iv(location, value.staged.size() / sizeof(GLint), ints);
+					break;
+			}
+			OpenGL::checkError();
+		}
+
+		OpenGLParameterBlock::Parameter::Parameter() :
+			count(0),
+			location(-1),
+			name(),
+			type(0)
+		{
+		}
+
+		OpenGLParameterBlock::Statistics::Statistics() :
+			redundantSets(0),
+			uploads(0)
+		{
+		}
+	}
+}
@@ -0,0 +1,197 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLPARAMETERBLOCK_H_
+#define OPENGLPARAMETERBLOCK_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * The loose (default block) uniforms of an OpenGL program, found by reflecting on the program once it has been
+		 * linked. Values are staged in CPU memory when they are set and only the ones that differ from what the program
+		 * already holds are uploaded when the block is flushed, so setting the same value for draw after draw costs
+		 * nothing.
+		 * </p>
+		 *
+		 * <p>
+		 * Setting a uniform the program does not have, or setting it with a value of the wrong type, is reported the
+		 * first time it happens instead of silently doing nothing. Uniforms that are declared in the source (see
+		 * setDeclaredNames()) but were optimized away by the compiler, as variants routinely do, are not reported.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLParameterBlock
+		{
+			public:
+				/**
+				 * <p>
+				 * A uniform found by reflection.
+				 * </p>
+				 */
+				struct SIMPLE_API Parameter
+				{
+					Parameter();
+
+					/**
+					 * <p>
+					 * The number of elements, greater than 1 for arrays.
+					 * </p>
+					 */
+					GLint count;
+
+					GLint location;
+
+					std::string name;
+
+					GLenum type;
+				};
+
+				/**
+				 * <p>
+				 * Upload statistics.
+				 * </p>
+				 */
+				struct SIMPLE_API Statistics
+				{
+					Statistics();
+
+					/**
+					 * <p>
+					 * Sets that were skipped because the value had not changed.
+					 * </p>
+					 */
+					unsigned int redundantSets;
+
+					unsigned int uploads;
+				};
+
+				OpenGLParameterBlock();
+
+				/**
+				 * <p>
+				 * Uploads the values that have changed since the last flush. The program must be in use.
+				 * </p>
+				 */
+				void flush();
+
+				/**
+				 * <p>
+				 * Retrieves a uniform by name.
+				 * </p>
+				 *
+				 * @param name The name of the uniform.
+				 *
+				 * @return The uniform or nullptr if the program does not have an active uniform with that name.
+				 */
+				const Parameter* getParameter(const std::string& name) const;
+
+				/**
+				 * @return The uniforms, by name.
+				 */
+				std::vector<const Parameter*> getParameters() const;
+
+				const Statistics& getStatistics() const;
+
+				/**
+				 * <p>
+				 * Forgets which values the program holds so every staged value is uploaded by the next flush, e.g.
+				 * because another block has uploaded its values to the same program since.
+				 * </p>
+				 */
+				void invalidate();
+
+				/**
+				 * <p>
+				 * Determines whether a type of uniform is a sampler.
+				 * </p>
+				 *
+				 * @param type The type of the uniform.
+				 *
+				 * @return True if the type is a sampler, false otherwise.
+				 */
+				static bool isSampler(GLenum type);
+
+				/**
+				 * <p>
+				 * Finds the active uniforms of a linked program. Values staged for a previous program are kept for the
+				 * uniforms the new program has with the same type, and are uploaded at the next flush.
+				 * </p>
+				 *
+				 * @param program The program.
+				 */
+				void reflect(GLuint program);
+
+				/**
+				 * <p>
+				 * Stages a value. Values of uniforms that are not active in the program are ignored, and reported if
+				 * the source does not declare them either.
+				 * </p>
+				 *
+				 * @param name The name of the uniform.
+				 * @param type The type of the value (GL_INT values can also be set on GL_BOOL and sampler uniforms).
+				 * @param data The value.
+				 * @param size The size of the value in bytes.
+				 */
+				void set(const std::string& name, GLenum type, const void* data, unsigned int size);
+
+				/**
+				 * <p>
+				 * Sets the names of the uniforms declared in the program's source (see
+				 * OpenGLShader::getUniformNames()), so that setting one the compiler optimized away is not reported.
+				 * </p>
+				 *
+				 * @param declaredNames The names of the uniforms.
+				 */
+				void setDeclaredNames(const std::set<std::string>& declaredNames);
+
+			private:
+				struct Value
+				{
+					bool dirty;
+
+					Parameter parameter;
+
+					std::vector<char> staged;
+
+					std::vector<char> uploaded;
+				};
+
+				std::set<std::string> declaredNames;
+
+				std::vector<Value*> dirtyValues;
+
+				std::set<std::string> reportedNames;
+
+				Statistics statistics;
+
+				std::map<std::string, Value> values;
+
+				bool isCompatible(GLenum parameterType, GLenum valueType) const;
+
+				void report(const std::string& name, const std::string& message);
+
+				void upload(const Value& value) const;
+		};
+	}
+}
+
+#endif /* OPENGLPARAMETERBLOCK_H_ */
@@ -14,13 +14,22 @@
  * You should have received a copy of the GNU General Public License along with The Simplicity Engine. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <set>
+
 #include <simplicity/logging/Logs.h>
 #include <simplicity/messaging/Messages.h>
 
 #include "../common/OpenGL.h"
 #include "../common/OpenGLBuffer.h"
+#include "OpenGLFrameConstants.h"
+#include "OpenGLParameterBlock.h"
 #include "OpenGLPipeline.h"
+#include "OpenGLProgramCache.h"
 #include "OpenGLShader.h"
+#include "OpenGLShaderReloader.h"
 
 using namespace std;
 
@@ -28,184 +37,945 @@ namespace simplicity
 {
 	namespace opengl
 	{
+		namespace
+		{
+			const OpenGLPipeline* appliedPipeline = nullptr;
+
+			unsigned int baseFeatures = 0;
+
+			map<string, GLuint> blockBindings;
+
+			// The macros a source tests with #ifdef, #ifndef or defined(). Names are matched as whole tokens outside
+			// of comments, so e.g. UNTEXTURED does not count as a test of TEXTURED.
+			set<string> getTestedMacros(const string& source)
+			{
+				string code = OpenGLShader::removeComments(source);
+
+				set<string> macros;
+				size_t lineStart = 0;
+				while (lineStart < code.size())
+				{
+					size_t lineEnd = min(code.find('\n', lineStart), code.size());
+					size_t directive = code.find_first_not_of(" \t", lineStart);
+
+					if (directive < lineEnd && code[directive] == '#')
+					{
+						// Punctuation is dropped, "defined(NAME)" and "defined NAME" both leave NAME after "defined".
+						vector<string> tokens;
+						for (size_t index = directive + 1; index < lineEnd;)
+						{
+							if (isalnum(static_cast<unsigned char>(code[index])) || code[index] == '_')
+							{
+								size_t tokenStart = index;
+								while (index < lineEnd &&
+										(isalnum(static_cast<unsigned char>(code[index])) || code[index] == '_'))
+								{
+									index++;
+								}
+								tokens.push_back(code.substr(tokenStart, index - tokenStart));
+							}
+							else
+							{
+								index++;
+							}
+						}
+
+						if (tokens.size() > 1 && (tokens[0] == "ifdef" || tokens[0] == "ifndef"))
+						{
+							macros.insert(tokens[1]);
+						}
+						else if (!tokens.empty() && (tokens[0] == "if" || tokens[0] == "elif"))
+						{
+							for (size_t token = 1; token + 1 < tokens.size(); token++)
+							{
+								if (tokens[token] == "defined")
+								{
+									macros.insert(tokens[token + 1]);
+								}
+							}
+						}
+					}
+
+					lineStart = lineEnd + 1;
+				}
+
+				return macros;
+			}
+		}
+
 		OpenGLPipeline::OpenGLPipeline(unique_ptr<Shader> vertexShader, unique_ptr<Shader> geometryShader,
 				unique_ptr<Shader> fragmentShader) :
+			OpenGLPipeline(move(vertexShader), move(geometryShader), move(fragmentShader), make_shared<Program>())
+		{
+		}
+
+		OpenGLPipeline::OpenGLPipeline(unique_ptr<Shader> vertexShader, unique_ptr<Shader> geometryShader,
+				unique_ptr<Shader> fragmentShader, shared_ptr<Program> program) :
 			fragmentShader(move(fragmentShader)),
 			geometryShader(move(geometryShader)),
-			initialized(false),
-			program(0),
+			parameters(),
+			parametersProgram(0),
+			pendingReload(),
+			program(program),
+			renderState(),
+			specializable(false),
+			variants(),
 			vertexShader(move(vertexShader))
 		{
+			specializable = hasFeatures();
+
+			if (!getResourceNames().empty())
+			{
+				OpenGLShaderReloader::watch(*this);
+			}
 		}
 
 		OpenGLPipeline::~OpenGLPipeline()
 		{
-			if (program != 0)
+			OpenGLShaderReloader::unwatch(*this);
+
+			if (pendingReload != nullptr)
+			{
+				glDeleteProgram(pendingReload->program);
+			}
+
+			// Another pipeline could be created at the same address.
+			if (program->owner == this)
 			{
-				glDeleteProgram(program);
+				program->owner = nullptr;
+			}
+
+			if (appliedPipeline == this)
+			{
+				appliedPipeline = nullptr;
 			}
 		}
 
 		void OpenGLPipeline::apply()
 		{
-			if (!initialized)
-			{
-				init();
-				initialized = true;
-			}
+			link();
 
 			// TODO Only needed for debugging apparently...
-			glValidateProgram(program);
+			glValidateProgram(program->name);
 			OpenGL::checkError();
 
 			GLint ValidateStatus;
-		    glGetProgramiv(program, GL_VALIDATE_STATUS, &ValidateStatus);
+		    glGetProgramiv(program->name, GL_VALIDATE_STATUS, &ValidateStatus);
 		    OpenGL::checkError();
 
 		    if (ValidateStatus == 0)
 		    {
 			    GLchar infoLog[1024];
-				glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
+				glGetProgramInfoLog(program->name, sizeof(infoLog), nullptr, infoLog);
 				OpenGL::checkError();
 
 				Logs::error("simplicity::opengl", "Error validating shader program:");
 				Logs::error("simplicity::opengl", infoLog);
 		    }
 
-			glUseProgram(program);
+			glUseProgram(program->name);
 			OpenGL::checkError();
+			appliedPipeline = this;
+
+			if (renderState != nullptr)
+			{
+				renderState->apply();
+			}
+			else if (OpenGLRenderState::getDefault() != nullptr)
+			{
+				OpenGLRenderState::getDefault()->apply();
+			}
+
+			flush();
 		}
 
-		void OpenGLPipeline::init()
+		bool OpenGLPipeline::beginReload(const map<string, string>& sources)
 		{
-			program = glCreateProgram();
+			unique_ptr<Reload> reload(new Reload);
+			bool changed = false;
 
-			if (vertexShader != nullptr)
+			unsigned int index = 0;
+			for (Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
 			{
-				static_cast<OpenGLShader&>(*vertexShader).init();
-				glAttachShader(program, static_cast<OpenGLShader&>(*vertexShader).getShader());
-				OpenGL::checkError();
+				if (shader != nullptr)
+				{
+					OpenGLShader* openGLShader = static_cast<OpenGLShader*>(shader);
+					const string& resourceName = openGLShader->getResourceName();
+
+					auto source = resourceName.empty() ? sources.end() : sources.find(resourceName);
+					if (source != sources.end() && source->second != openGLShader->getSource())
+					{
+						reload->shaders[index].reset(new OpenGLShader(openGLShader->getType(), source->second,
+								resourceName));
+						changed = true;
+					}
+					else
+					{
+						// Shares the already compiled shader.
+						reload->shaders[index].reset(new OpenGLShader(*openGLShader));
+					}
+				}
+
+				index++;
+			}
+
+			if (!changed)
+			{
+				return false;
+			}
+
+			startReload(move(reload));
+
+			// The variants are relinked from the new source alongside, so they are all switched over together.
+			for (pair<const unsigned int, unique_ptr<OpenGLPipeline>>& variant : variants)
+			{
+				vector<string> defines = getFeatureNames(variant.first);
+				unique_ptr<Reload> variantReload(new Reload);
+				for (unsigned int index = 0; index < 3; index++)
+				{
+					const OpenGLShader* shader = static_cast<const OpenGLShader*>(pendingReload->shaders[index].get());
+					if (shader != nullptr)
+					{
+						variantReload->shaders[index].reset(new OpenGLShader(shader->getType(),
+								OpenGLShader::addDefines(shader->getSource(), defines)));
+					}
+				}
+
+				variant.second->startReload(move(variantReload));
 			}
 
-			if (geometryShader != nullptr)
+			return true;
+		}
+
+		void OpenGLPipeline::bindBuffer(const string& name, const Buffer& value, unsigned int offset,
+				unsigned int size)
+		{
+			link();
+
+			auto uniformBlock = program->uniformBlocks.find(name);
+			if (uniformBlock == program->uniformBlocks.end())
 			{
-				static_cast<OpenGLShader&>(*geometryShader).init();
-				glAttachShader(program, static_cast<OpenGLShader&>(*geometryShader).getShader());
+				// Not an active block in this program (it may have been optimized away).
+				return;
+			}
+
+			static_cast<const OpenGLBuffer&>(value).bindRange(GL_UNIFORM_BUFFER, uniformBlock->second, offset, size);
+		}
+
+		void OpenGLPipeline::bindUniformBlocks()
+		{
+			program->uniformBlocks.clear();
+
+			GLint blockCount = 0;
+			glGetProgramiv(program->name, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+			OpenGL::checkError();
+
+			for (GLint index = 0; index < blockCount; index++)
+			{
+				GLchar blockName[256];
+				glGetActiveUniformBlockName(program->name, index, sizeof(blockName), nullptr, blockName);
 				OpenGL::checkError();
+
+				GLuint binding = getUniformBlockBinding(blockName);
+				glUniformBlockBinding(program->name, index, binding);
+				OpenGL::checkError();
+
+				program->uniformBlocks[blockName] = binding;
+			}
+		}
+
+		void OpenGLPipeline::bindUniformBuffer(const string& blockName, const Buffer& buffer, unsigned int offset,
+				unsigned int size)
+		{
+			static_cast<const OpenGLBuffer&>(buffer).bindRange(GL_UNIFORM_BUFFER, getUniformBlockBinding(blockName),
+					offset, size);
+		}
+
+		void OpenGLPipeline::compile()
+		{
+			if (!program->initialized)
+			{
+				init();
 			}
+		}
 
-			if (fragmentShader != nullptr)
+		void OpenGLPipeline::compileAll(const vector<shared_ptr<Pipeline>>& pipelines)
+		{
+			// Let the driver use as many threads as it likes.
+			if (GLEW_KHR_parallel_shader_compile)
 			{
-				static_cast<OpenGLShader&>(*fragmentShader).init();
-				glAttachShader(program, static_cast<OpenGLShader&>(*fragmentShader).getShader());
+				glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+				OpenGL::checkError();
+			}
+			else if (GLEW_ARB_parallel_shader_compile)
+			{
+				glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
 				OpenGL::checkError();
 			}
 
-			glLinkProgram(program);
+			for (const shared_ptr<Pipeline>& pipeline : pipelines)
+			{
+				OpenGLPipeline* openGLPipeline = dynamic_cast<OpenGLPipeline*>(pipeline.get());
+				if (openGLPipeline != nullptr)
+				{
+					openGLPipeline->compile();
+				}
+			}
+		}
+
+		void OpenGLPipeline::compileVariants(const vector<unsigned int>& featureSets)
+		{
+			for (unsigned int features : featureSets)
+			{
+				getVariant(features).compile();
+			}
+		}
+
+		void OpenGLPipeline::finishLink()
+		{
+			chrono::steady_clock::time_point linkStart = chrono::steady_clock::now();
+
+			for (Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+			{
+				if (shader != nullptr)
+				{
+					static_cast<OpenGLShader*>(shader)->checkCompileStatus();
+				}
+			}
 
 			GLint linkStatus;
-			glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+			glGetProgramiv(program->name, GL_LINK_STATUS, &linkStatus);
 			OpenGL::checkError();
 
+			program->compileTime += chrono::duration<double, milli>(chrono::steady_clock::now() - linkStart).count();
+
 			if (linkStatus == 0)
 			{
 			    GLchar infoLog[1024];
-				glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
+				glGetProgramInfoLog(program->name, sizeof(infoLog), nullptr, infoLog);
 				OpenGL::checkError();
 
 				Logs::error("simplicity::opengl", "Error linking shader program:");
 				Logs::error("simplicity::opengl", infoLog);
 			}
+			else
+			{
+				if (OpenGLProgramCache::isEnabled())
+				{
+					// Compiling on the driver's threads cannot be timed from here, so it is not reported.
+					if (!(GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile))
+					{
+						OpenGLProgramCache::recordCompileTime(program->compileTime);
+					}
+					OpenGLProgramCache::store(program->cacheKey, program->name);
+				}
+
+				reflect();
+			}
+
+			program->linked = true;
 		}
 
-		void OpenGLPipeline::set(const string& name, const Buffer& value)
+		bool OpenGLPipeline::finishReload(bool wait)
 		{
-			// TODO Only supports a single uniform buffer so far... we could maintain a map of buffers to indexes to
-			// allow redundant setting.
-			glUniformBlockBinding(program, glGetUniformBlockIndex(program, name.data()), 0);
+			if (pendingReload == nullptr)
+			{
+				return true;
+			}
+
+			if (!wait)
+			{
+				if (!isReloadReady())
+				{
+					return false;
+				}
+
+				for (pair<const unsigned int, unique_ptr<OpenGLPipeline>>& variant : variants)
+				{
+					if (!variant.second->isReloadReady())
+					{
+						return false;
+					}
+				}
+			}
+
+			for (unique_ptr<Shader>& shader : pendingReload->shaders)
+			{
+				if (shader != nullptr)
+				{
+					static_cast<OpenGLShader*>(shader.get())->checkCompileStatus();
+				}
+			}
+
+			GLint linkStatus;
+			glGetProgramiv(pendingReload->program, GL_LINK_STATUS, &linkStatus);
 			OpenGL::checkError();
 
-			const OpenGLBuffer& openGLBuffer = static_cast<const OpenGLBuffer&>(value);
-			glBindBufferBase(GL_UNIFORM_BUFFER, 0, openGLBuffer.getName());
+			if (linkStatus == 0)
+			{
+				GLchar infoLog[1024];
+				glGetProgramInfoLog(pendingReload->program, sizeof(infoLog), nullptr, infoLog);
+				OpenGL::checkError();
+
+				Logs::error("simplicity::opengl", "Error reloading shader program, keeping the previous one:");
+				Logs::error("simplicity::opengl", infoLog);
+
+				glDeleteProgram(pendingReload->program);
+				OpenGL::checkError();
+				pendingReload.reset();
+
+				// The variants stay in step with the program they were compiled from.
+				for (pair<const unsigned int, unique_ptr<OpenGLPipeline>>& variant : variants)
+				{
+					if (variant.second->pendingReload != nullptr)
+					{
+						glDeleteProgram(variant.second->pendingReload->program);
+						OpenGL::checkError();
+						variant.second->pendingReload.reset();
+					}
+				}
+
+				return true;
+			}
+
+			// The old program stays with any other pipelines sharing it (and is only really deleted once it is no
+			// longer in use).
+			if (program->owner == this)
+			{
+				program->owner = nullptr;
+			}
+
+			// The new program is not in use until the pipeline is applied again.
+			if (appliedPipeline == this)
+			{
+				appliedPipeline = nullptr;
+			}
+
+			program = make_shared<Program>();
+			program->initialized = true;
+			program->linked = true;
+			program->name = pendingReload->program;
+			vertexShader = move(pendingReload->shaders[0]);
+			geometryShader = move(pendingReload->shaders[1]);
+			fragmentShader = move(pendingReload->shaders[2]);
+			pendingReload.reset();
+
+			reflect();
+			link();
+
+			// The variants have finished linking too (see above). A variant that failed keeps its old program.
+			specializable = hasFeatures();
+			for (pair<const unsigned int, unique_ptr<OpenGLPipeline>>& variant : variants)
+			{
+				variant.second->finishReload(true);
+			}
+
+			Logs::info("simplicity::opengl", "Reloaded shader program %u", program->name);
+
+			return true;
+		}
+
+		void OpenGLPipeline::flush()
+		{
+			// The program holds the values uploaded by whichever pipeline sharing it was flushed last.
+			if (program->owner != this)
+			{
+				parameters.invalidate();
+				program->owner = this;
+			}
+
+			parameters.flush();
+		}
+
+		GLint OpenGLPipeline::getAttributeLocation(const string& name) const
+		{
+			auto attribute = program->attributes.find(name);
+			if (attribute == program->attributes.end())
+			{
+				return -1;
+			}
+
+			return attribute->second;
+		}
+
+		unsigned int OpenGLPipeline::getBaseFeatures()
+		{
+			return baseFeatures;
+		}
+
+		vector<string> OpenGLPipeline::getFeatureNames(unsigned int features)
+		{
+			vector<string> names;
+
+			if ((features & BLOOM_OUTPUT) != 0)
+			{
+				names.push_back("BLOOM_OUTPUT");
+			}
+
+			if ((features & DEPTH_ONLY) != 0)
+			{
+				names.push_back("DEPTH_ONLY");
+			}
+
+			if ((features & TEXTURED) != 0)
+			{
+				names.push_back("TEXTURED");
+			}
+
+			if ((features & VERTEX_COLOR) != 0)
+			{
+				names.push_back("VERTEX_COLOR");
+			}
+
+			return names;
+		}
+
+		const OpenGLParameterBlock& OpenGLPipeline::getParameters() const
+		{
+			return parameters;
+		}
+
+		shared_ptr<OpenGLPipeline::Program> OpenGLPipeline::getProgram() const
+		{
+			return program;
+		}
+
+		shared_ptr<const OpenGLRenderState> OpenGLPipeline::getRenderState() const
+		{
+			return renderState;
+		}
+
+		vector<string> OpenGLPipeline::getResourceNames() const
+		{
+			vector<string> resourceNames;
+			for (const Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+			{
+				if (shader != nullptr && !static_cast<const OpenGLShader*>(shader)->getResourceName().empty())
+				{
+					resourceNames.push_back(static_cast<const OpenGLShader*>(shader)->getResourceName());
+				}
+			}
+
+			return resourceNames;
+		}
+
+		GLuint OpenGLPipeline::getUniformBlockBinding(const string& blockName)
+		{
+			auto blockBinding = blockBindings.find(blockName);
+			if (blockBinding != blockBindings.end())
+			{
+				return blockBinding->second;
+			}
+
+			GLint maxBindings = 0;
+			glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings);
 			OpenGL::checkError();
+
+			GLuint binding = static_cast<GLuint>(blockBindings.size());
+			if (binding >= static_cast<GLuint>(maxBindings))
+			{
+				Logs::error("simplicity::opengl", "Out of uniform buffer binding points, sharing the last one with %s.",
+						blockName.data());
+				binding = maxBindings - 1;
+			}
+
+			blockBindings[blockName] = binding;
+
+			return binding;
 		}
 
-		void OpenGLPipeline::set(const string& name, float value)
+		GLint OpenGLPipeline::getUniformBufferOffsetAlignment()
+		{
+			static GLint alignment = 0;
+			if (alignment == 0)
+			{
+				glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+				OpenGL::checkError();
+			}
+
+			return alignment;
+		}
+
+		OpenGLPipeline& OpenGLPipeline::getVariant(unsigned int features)
+		{
+			if (features == 0 || !specializable)
+			{
+				return *this;
+			}
+
+			auto variant = variants.find(features);
+			if (variant != variants.end())
+			{
+				return *variant->second;
+			}
+
+			vector<string> defines = getFeatureNames(features);
+			unique_ptr<Shader> variantShaders[3];
+			unsigned int index = 0;
+			for (Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+			{
+				if (shader != nullptr)
+				{
+					const OpenGLShader* openGLShader = static_cast<const OpenGLShader*>(shader);
+					variantShaders[index].reset(new OpenGLShader(openGLShader->getType(),
+							OpenGLShader::addDefines(openGLShader->getSource(), defines)));
+				}
+
+				index++;
+			}
+
+			// Share the variant's program with the pipelines sharing this one's.
+			shared_ptr<Program> variantProgram = program->variants[features].lock();
+			if (variantProgram == nullptr)
+			{
+				variantProgram = make_shared<Program>();
+				program->variants[features] = variantProgram;
+			}
+
+			OpenGLPipeline* newVariant = new OpenGLPipeline(move(variantShaders[0]), move(variantShaders[1]),
+					move(variantShaders[2]), variantProgram);
+			newVariant->setRenderState(renderState);
+			variants[features].reset(newVariant);
+
+			return *newVariant;
+		}
+
+		bool OpenGLPipeline::hasFeatures() const
 		{
-			glUniform1f(glGetUniformLocation(program, name.data()), value);
+			vector<string> allFeatures = getFeatureNames(BLOOM_OUTPUT | DEPTH_ONLY | TEXTURED | VERTEX_COLOR);
+			for (const Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+			{
+				if (shader == nullptr)
+				{
+					continue;
+				}
+
+				// Qualified since our own set() methods hide the container.
+				std::set<string> testedMacros =
+						getTestedMacros(static_cast<const OpenGLShader*>(shader)->getSource());
+				for (const string& feature : allFeatures)
+				{
+					if (testedMacros.find(feature) != testedMacros.end())
+					{
+						return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		void OpenGLPipeline::init()
+		{
+			program->name = glCreateProgram();
+			program->initialized = true;
+
+			// Try to skip compiling and linking altogether.
+			if (OpenGLProgramCache::isEnabled())
+			{
+				vector<string> sources;
+				for (Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+				{
+					sources.push_back(shader == nullptr ? "" : static_cast<OpenGLShader*>(shader)->getSource());
+				}
+
+				program->cacheKey = OpenGLProgramCache::createKey(sources);
+				if (OpenGLProgramCache::load(program->cacheKey, program->name))
+				{
+					reflect();
+					program->linked = true;
+					return;
+				}
+			}
+
+			chrono::steady_clock::time_point compileStart = chrono::steady_clock::now();
+
+			// Nothing here queries a compile or link status, so the driver is free to work on this program while we
+			// move on to the next one.
+			for (Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+			{
+				if (shader != nullptr)
+				{
+					static_cast<OpenGLShader*>(shader)->compile();
+					glAttachShader(program->name, static_cast<OpenGLShader*>(shader)->getShader());
+					OpenGL::checkError();
+				}
+			}
+
+			if (OpenGLProgramCache::isEnabled())
+			{
+				glProgramParameteri(program->name, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+				OpenGL::checkError();
+			}
+
+			glLinkProgram(program->name);
 			OpenGL::checkError();
+
+			// Only the time spent in the driver counts, not the frames that pass before the program is linked.
+			program->compileTime += chrono::duration<double, milli>(chrono::steady_clock::now() - compileStart).count();
 		}
 
-		void OpenGLPipeline::set(const string& name, int value)
+		bool OpenGLPipeline::isLinked() const
 		{
-			glUniform1i(glGetUniformLocation(program, name.data()), value);
+			return program->linked;
+		}
+
+		bool OpenGLPipeline::isReloadReady() const
+		{
+			if (pendingReload == nullptr || !(GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile))
+			{
+				return true;
+			}
+
+			GLint completionStatus = GL_FALSE;
+			glGetProgramiv(pendingReload->program, GL_COMPLETION_STATUS_KHR, &completionStatus);
 			OpenGL::checkError();
+
+			return completionStatus == GL_TRUE;
 		}
 
-		void OpenGLPipeline::set(const string& name, const Matrix44& value)
+		bool OpenGLPipeline::isReady() const
 		{
-			glUniformMatrix4fv(glGetUniformLocation(program, name.data()), 1, GL_FALSE, value.getData());
+			if (!program->initialized)
+			{
+				return false;
+			}
+
+			if (program->linked || !(GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile))
+			{
+				return true;
+			}
+
+			GLint completionStatus = GL_FALSE;
+			glGetProgramiv(program->name, GL_COMPLETION_STATUS_KHR, &completionStatus);
 			OpenGL::checkError();
+
+			return completionStatus == GL_TRUE;
 		}
 
-		void OpenGLPipeline::set(const string& name, const Vector2& value)
+		void OpenGLPipeline::link()
 		{
-			glUniform2fv(glGetUniformLocation(program, name.data()), 1, value.getData());
+			if (!program->initialized)
+			{
+				init();
+			}
+
+			if (!program->linked)
+			{
+				finishLink();
+			}
+
+			// The program may have been linked by another pipeline sharing it.
+			if (program->valid && parametersProgram != program->name)
+			{
+				parameters.reflect(program->name);
+				parametersProgram = program->name;
+
+				// Qualified since our own set() methods hide the container.
+				std::set<string> declaredNames;
+				for (Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+				{
+					if (shader != nullptr)
+					{
+						std::set<string> shaderNames =
+								OpenGLShader::getUniformNames(static_cast<OpenGLShader*>(shader)->getSource());
+						declaredNames.insert(shaderNames.begin(), shaderNames.end());
+					}
+				}
+				parameters.setDeclaredNames(declaredNames);
+			}
+		}
+
+		OpenGLPipeline::Program::Program() :
+			attributes(),
+			cacheKey(0),
+			compileTime(0.0),
+			initialized(false),
+			linked(false),
+			name(0),
+			owner(nullptr),
+			uniformBlocks(),
+			valid(false),
+			variants()
+		{
+		}
+
+		OpenGLPipeline::Program::~Program()
+		{
+			if (name != 0)
+			{
+				glDeleteProgram(name);
+			}
+		}
+
+		void OpenGLPipeline::reflect()
+		{
+			bindUniformBlocks();
+
+			program->attributes.clear();
+			program->valid = true;
+
+			GLint attributeCount = 0;
+			glGetProgramiv(program->name, GL_ACTIVE_ATTRIBUTES, &attributeCount);
 			OpenGL::checkError();
+
+			for (GLint index = 0; index < attributeCount; index++)
+			{
+				GLchar name[256];
+				GLint size;
+				GLenum type;
+				glGetActiveAttrib(program->name, index, sizeof(name), nullptr, &size, &type, name);
+				OpenGL::checkError();
+
+				program->attributes[name] = glGetAttribLocation(program->name, name);
+				OpenGL::checkError();
+			}
+		}
+
+		void OpenGLPipeline::resetApplied()
+		{
+			appliedPipeline = nullptr;
+		}
+
+		void OpenGLPipeline::set(const string& name, const Buffer& value)
+		{
+			bindBuffer(name, value, 0, 0);
+		}
+
+		void OpenGLPipeline::set(const string& name, const Buffer& value, unsigned int offset, unsigned int size)
+		{
+			if (offset % getUniformBufferOffsetAlignment() != 0)
+			{
+				Logs::error("simplicity::opengl", "Uniform buffer offset %u for block %s is not aligned to %d bytes.",
+						offset, name.data(), getUniformBufferOffsetAlignment());
+				return;
+			}
+
+			bindBuffer(name, value, offset, size);
+		}
+
+		void OpenGLPipeline::set(const string& name, float value)
+		{
+			setParameter(name, GL_FLOAT, &value, sizeof(value));
+		}
+
+		void OpenGLPipeline::set(const string& name, int value)
+		{
+			setParameter(name, GL_INT, &value, sizeof(value));
+		}
+
+		void OpenGLPipeline::set(const string& name, const Matrix44& value)
+		{
+			link();
+
+			if (program->uniformBlocks.find(OpenGLFrameConstants::BLOCK_NAME) != program->uniformBlocks.end() &&
+					OpenGLFrameConstants::set(name, value))
+			{
+				return;
+			}
+
+			setParameter(name, GL_FLOAT_MAT4, value.getData(), sizeof(float) * 16);
+		}
+
+		void OpenGLPipeline::set(const string& name, const Vector2& value)
+		{
+			setParameter(name, GL_FLOAT_VEC2, value.getData(), sizeof(float) * 2);
 		}
 
 		void OpenGLPipeline::set(const string& name, const Vector3& value)
 		{
-			glUniform3fv(glGetUniformLocation(program, name.data()), 1, value.getData());
-			OpenGL::checkError();
+			setParameter(name, GL_FLOAT_VEC3, value.getData(), sizeof(float) * 3);
 		}
 
 		void OpenGLPipeline::set(const string& name, const Vector4& value)
 		{
-			glUniform4fv(glGetUniformLocation(program, name.data()), 1, value.getData());
-			OpenGL::checkError();
+			setParameter(name, GL_FLOAT_VEC4, value.getData(), sizeof(float) * 4);
 		}
 
 		void OpenGLPipeline::set(const string& structName, const string& name, float value)
 		{
-			string qualifiedName = structName + "." + name;
-			glUniform1f(glGetUniformLocation(program, qualifiedName.data()), value);
-			OpenGL::checkError();
+			setParameter(structName + "." + name, GL_FLOAT, &value, sizeof(value));
 		}
 
 		void OpenGLPipeline::set(const string& structName, const string& name, int value)
 		{
-			string qualifiedName = structName + "." + name;
-			glUniform1i(glGetUniformLocation(program, qualifiedName.data()), value);
-			OpenGL::checkError();
+			setParameter(structName + "." + name, GL_INT, &value, sizeof(value));
 		}
 
 		void OpenGLPipeline::set(const string& structName, const string& name, const Matrix44& value)
 		{
-			string qualifiedName = structName + "." + name;
-			glUniformMatrix4fv(glGetUniformLocation(program, qualifiedName.data()), 1, GL_FALSE, value.getData());
-			OpenGL::checkError();
+			setParameter(structName + "." + name, GL_FLOAT_MAT4, value.getData(), sizeof(float) * 16);
 		}
 
 		void OpenGLPipeline::set(const string& structName, const string& name, const Vector2& value)
 		{
-			string qualifiedName = structName + "." + name;
-			glUniform2fv(glGetUniformLocation(program, qualifiedName.data()), 1, value.getData());
-			OpenGL::checkError();
+			setParameter(structName + "." + name, GL_FLOAT_VEC2, value.getData(), sizeof(float) * 2);
 		}
 
 		void OpenGLPipeline::set(const string& structName, const string& name, const Vector3& value)
 		{
-			string qualifiedName = structName + "." + name;
-			glUniform3fv(glGetUniformLocation(program, qualifiedName.data()), 1, value.getData());
-			OpenGL::checkError();
+			setParameter(structName + "." + name, GL_FLOAT_VEC3, value.getData(), sizeof(float) * 3);
 		}
 
 		void OpenGLPipeline::set(const string& structName, const string& name, const Vector4& value)
 		{
-			string qualifiedName = structName + "." + name;
-			glUniform4fv(glGetUniformLocation(program, qualifiedName.data()), 1, value.getData());
+			setParameter(structName + "." + name, GL_FLOAT_VEC4, value.getData(), sizeof(float) * 4);
+		}
+
+		void OpenGLPipeline::setParameter(const string& name, GLenum type, const void* data, unsigned int size)
+		{
+			link();
+
+			parameters.set(name, type, data, size);
+
+			// Nothing else will upload it if the caller draws straight away.
+			if (appliedPipeline == this)
+			{
+				flush();
+			}
+		}
+
+		void OpenGLPipeline::setBaseFeatures(unsigned int features)
+		{
+			baseFeatures = features;
+		}
+
+		void OpenGLPipeline::setRenderState(shared_ptr<const OpenGLRenderState> renderState)
+		{
+			this->renderState = renderState;
+
+			for (pair<const unsigned int, unique_ptr<OpenGLPipeline>>& variant : variants)
+			{
+				variant.second->setRenderState(renderState);
+			}
+		}
+
+		void OpenGLPipeline::startReload(unique_ptr<Reload> reload)
+		{
+			// Only the latest source matters.
+			if (pendingReload != nullptr)
+			{
+				glDeleteProgram(pendingReload->program);
+				OpenGL::checkError();
+			}
+
+			reload->program = glCreateProgram();
+			OpenGL::checkError();
+
+			for (unique_ptr<Shader>& shader : reload->shaders)
+			{
+				if (shader != nullptr)
+				{
+					static_cast<OpenGLShader*>(shader.get())->compile();
+					glAttachShader(reload->program, static_cast<OpenGLShader*>(shader.get())->getShader());
+					OpenGL::checkError();
+				}
+			}
+
+			glLinkProgram(reload->program);
 			OpenGL::checkError();
+
+			pendingReload = move(reload);
 		}
 	}
 }
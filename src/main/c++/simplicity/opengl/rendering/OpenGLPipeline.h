@@ -17,29 +17,363 @@
 #ifndef OPENGLPIPELINE_H_
 #define OPENGLPIPELINE_H_
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include <GL/glew.h>
 
 #include <simplicity/rendering/Pipeline.h>
 #include <simplicity/rendering/Shader.h>
+#include <simplicity/resources/Resource.h>
+
+#include "OpenGLParameterBlock.h"
+#include "OpenGLRenderState.h"
 
 namespace simplicity
 {
 	namespace opengl
 	{
+		/**
+		 * <p>
+		 * A pipeline implemented using an OpenGL program.
+		 * </p>
+		 *
+		 * <p>
+		 * Uniform blocks are given binding points by name when the program is linked. A block name always maps to the
+		 * same binding point in every pipeline, so a buffer bound for one pipeline remains bound for all of them and
+		 * several blocks can be live at the same time.
+		 * </p>
+		 *
+		 * <p>
+		 * Matrices named after members of the FrameConstants block (see OpenGLFrameConstants) are written to that block
+		 * rather than set as loose uniforms when the program uses it.
+		 * </p>
+		 *
+		 * <p>
+		 * Uniforms and attributes are reflected from the program when it is linked. Uniform values are staged in an
+		 * OpenGLParameterBlock and only the ones that changed are uploaded, when the pipeline is applied or straight
+		 * away if it is already applied. Setting a uniform the program does not use (e.g. because the compiler
+		 * optimized it away) does nothing.
+		 * </p>
+		 *
+		 * <p>
+		 * Variants of a pipeline can be compiled with sets of features #defined in its shaders (see Feature). Shaders
+		 * specialise themselves with #ifdef so no branching on uniforms is needed at run time.
+		 * </p>
+		 */
 		class SIMPLE_API OpenGLPipeline : public Pipeline
 		{
 			public:
+				/**
+				 * <p>
+				 * The features a pipeline variant can be compiled with. Each one is #defined by name in the variant's
+				 * shaders.
+				 * </p>
+				 */
+				enum Feature : unsigned int
+				{
+					/**
+					 * <p>
+					 * Writes the second (bloom) color output when rendering to multiple targets.
+					 * </p>
+					 */
+					BLOOM_OUTPUT = 1 << 0,
+
+					/**
+					 * <p>
+					 * Only positions are computed and no colors are written, for depth pre-passes.
+					 * </p>
+					 */
+					DEPTH_ONLY = 1 << 3,
+
+					/**
+					 * <p>
+					 * Colors fragments from the texture bound to unit 0.
+					 * </p>
+					 */
+					TEXTURED = 1 << 1,
+
+					/**
+					 * <p>
+					 * Colors fragments with the interpolated vertex color.
+					 * </p>
+					 */
+					VERTEX_COLOR = 1 << 2
+				};
+
+				/**
+				 * <p>
+				 * An OpenGL program, shared between pipelines made of the same shaders so it is only linked once (see
+				 * OpenGLRenderingFactory). Uniform values are staged by each pipeline and uploaded again whenever a
+				 * different pipeline than the last one applies the program.
+				 * </p>
+				 */
+				struct Program
+				{
+					Program();
+
+					~Program();
+
+					Program(const Program&) = delete;
+
+					Program& operator=(const Program&) = delete;
+
+					std::map<std::string, GLint> attributes;
+
+					std::uint64_t cacheKey;
+
+					double compileTime;
+
+					bool initialized;
+
+					bool linked;
+
+					GLuint name;
+
+					/**
+					 * <p>
+					 * The pipeline whose uniform values were last uploaded to the program.
+					 * </p>
+					 */
+					const OpenGLPipeline* owner;
+
+					std::map<std::string, GLuint> uniformBlocks;
+
+					bool valid;
+
+					/**
+					 * <p>
+					 * The programs of the variants compiled by any of the pipelines sharing this program.
+					 * </p>
+					 */
+					std::map<unsigned int, std::weak_ptr<Program>> variants;
+				};
+
 				OpenGLPipeline(std::unique_ptr<Shader> vertexShader, std::unique_ptr<Shader> geometryShader,
 						std::unique_ptr<Shader> fragmentShader);
 
+				/**
+				 * <p>
+				 * Creates a pipeline that shares an already created program. The shaders must be the ones the program
+				 * was created from.
+				 * </p>
+				 *
+				 * @param vertexShader The vertex shader.
+				 * @param geometryShader The geometry shader.
+				 * @param fragmentShader The fragment shader.
+				 * @param program The program to share.
+				 */
+				OpenGLPipeline(std::unique_ptr<Shader> vertexShader, std::unique_ptr<Shader> geometryShader,
+						std::unique_ptr<Shader> fragmentShader, std::shared_ptr<Program> program);
+
 				~OpenGLPipeline();
 
 				void apply() override;
 
+				/**
+				 * <p>
+				 * Starts relinking the pipeline with new source for the shaders that were loaded from resources,
+				 * without waiting for the result. The pipeline keeps using its current program until the new one has
+				 * linked successfully (see finishReload()).
+				 * </p>
+				 *
+				 * @param sources The new source, by the name of the resource it was loaded from.
+				 *
+				 * @return True if the source of any of the pipeline's shaders changed, false otherwise.
+				 */
+				bool beginReload(const std::map<std::string, std::string>& sources);
+
+				/**
+				 * <p>
+				 * Binds a range of a buffer to the binding point of a uniform block name, making it available to every
+				 * pipeline with a block of that name.
+				 * </p>
+				 *
+				 * @param blockName The name of the uniform block.
+				 * @param buffer The buffer.
+				 * @param offset The offset of the range in bytes, 0 when binding the whole buffer.
+				 * @param size The size of the range in bytes, 0 binds the whole buffer.
+				 */
+				static void bindUniformBuffer(const std::string& blockName, const Buffer& buffer, unsigned int offset,
+						unsigned int size);
+
+				/**
+				 * <p>
+				 * Submits the pipeline's shaders for compilation and linking without waiting for the result. The result
+				 * is checked when the pipeline is first applied.
+				 * </p>
+				 */
+				void compile();
+
+				/**
+				 * <p>
+				 * Submits a batch of pipelines for compilation and linking before checking any of the results, using
+				 * GL_KHR_parallel_shader_compile when available. Pipelines that are not OpenGLPipelines are ignored.
+				 * </p>
+				 *
+				 * @param pipelines The pipelines to compile.
+				 */
+				static void compileAll(const std::vector<std::shared_ptr<Pipeline>>& pipelines);
+
+				/**
+				 * <p>
+				 * Submits a set of variants for compilation and linking without waiting for the results, so they are
+				 * ready before they are first needed.
+				 * </p>
+				 *
+				 * @param featureSets The bitmasks of Features of the variants to compile.
+				 */
+				void compileVariants(const std::vector<unsigned int>& featureSets);
+
+				/**
+				 * <p>
+				 * Checks on a reload started with beginReload(). If the new program linked successfully it replaces the
+				 * current one, otherwise the errors are logged and the current program is kept.
+				 * </p>
+				 *
+				 * @param wait Whether to wait for the driver to finish compiling and linking. Without
+				 * GL_KHR_parallel_shader_compile the driver cannot say whether it has finished, so this always waits.
+				 *
+				 * @return True if the reload has finished (or there was none), false if the driver is still working on
+				 * it.
+				 */
+				bool finishReload(bool wait = false);
+
+				/**
+				 * <p>
+				 * Uploads the uniform values that have changed since the pipeline was applied or last flushed. Values
+				 * set while the pipeline is applied are uploaded as they are set, so there is rarely anything left to
+				 * upload.
+				 * </p>
+				 */
+				void flush();
+
+				/**
+				 * <p>
+				 * Retrieves the location of a vertex attribute.
+				 * </p>
+				 *
+				 * @param name The name of the attribute.
+				 *
+				 * @return The location or -1 if the program does not have an active attribute with that name.
+				 */
+				GLint getAttributeLocation(const std::string& name) const;
+
+				/**
+				 * <p>
+				 * Retrieves the features every variant drawn into the scene needs on top of its own, e.g. BLOOM_OUTPUT
+				 * while the OpenGLRenderingEngine has a post processor reading the second color output.
+				 * </p>
+				 *
+				 * @return The bitmask of Features.
+				 */
+				static unsigned int getBaseFeatures();
+
+				/**
+				 * @return The program, shared with any other pipelines made of the same shaders.
+				 */
+				std::shared_ptr<Program> getProgram() const;
+
+				/**
+				 * @return The fixed-function state applied with the pipeline, nullptr if it uses the default (see
+				 * OpenGLRenderState::getDefault()).
+				 */
+				std::shared_ptr<const OpenGLRenderState> getRenderState() const;
+
+				/**
+				 * @return The names of the resources the pipeline's shaders were loaded from.
+				 */
+				std::vector<std::string> getResourceNames() const;
+
+				/**
+				 * @return The uniforms of the program.
+				 */
+				const OpenGLParameterBlock& getParameters() const;
+
+				/**
+				 * <p>
+				 * Retrieves the binding point assigned to a uniform block name, assigning the next free binding point
+				 * if the name has not been seen before.
+				 * </p>
+				 *
+				 * @param blockName The name of the uniform block.
+				 *
+				 * @return The binding point.
+				 */
+				static GLuint getUniformBlockBinding(const std::string& blockName);
+
+				/**
+				 * <p>
+				 * Retrieves the alignment required of offsets passed to set(name, value, offset, size).
+				 * </p>
+				 *
+				 * @return The alignment in bytes.
+				 */
+				static GLint getUniformBufferOffsetAlignment();
+
+				/**
+				 * <p>
+				 * Retrieves the variant of this pipeline compiled with a set of features, creating it if it does not
+				 * exist yet. If none of this pipeline's shaders check for any of the features this pipeline is
+				 * returned.
+				 * </p>
+				 *
+				 * @param features The bitmask of Features.
+				 *
+				 * @return The variant.
+				 */
+				OpenGLPipeline& getVariant(unsigned int features);
+
+				/**
+				 * @return True if the pipeline has been compiled and linked and the result checked, false otherwise.
+				 */
+				bool isLinked() const;
+
+				/**
+				 * <p>
+				 * Determines whether the pipeline can be applied without waiting for the driver to finish compiling and
+				 * linking. Without GL_KHR_parallel_shader_compile this is true as soon as the pipeline is compiled.
+				 * </p>
+				 *
+				 * @return True if the pipeline can be applied without waiting, false otherwise.
+				 */
+				bool isReady() const;
+
+				/**
+				 * <p>
+				 * Compiles and links the pipeline if needed and checks the result, waiting for the driver if it has not
+				 * finished yet.
+				 * </p>
+				 */
+				void link();
+
+				/**
+				 * <p>
+				 * Forgets which pipeline is applied. Must be called when another program is put in use without
+				 * applying a pipeline (e.g. by an OpenGLComputeProgram), so values set afterwards are staged rather
+				 * than uploaded to the wrong program.
+				 * </p>
+				 */
+				static void resetApplied();
+
 				void set(const std::string& name, const Buffer& value) override;
 
+				/**
+				 * <p>
+				 * Sets a uniform block to a range of a buffer, allowing several blocks to be sub-allocated from one
+				 * large buffer.
+				 * </p>
+				 *
+				 * @param name The name of the uniform block.
+				 * @param value The buffer.
+				 * @param offset The offset of the range in bytes. Must be a multiple of
+				 * getUniformBufferOffsetAlignment(), and 0 when binding the whole buffer.
+				 * @param size The size of the range in bytes, 0 binds the whole buffer.
+				 */
+				void set(const std::string& name, const Buffer& value, unsigned int offset, unsigned int size);
+
 				void set(const std::string& name, float value) override;
 
 				void set(const std::string& name, int value) override;
@@ -64,17 +398,81 @@ namespace simplicity
 
 				void set(const std::string& structName, const std::string& name, const Vector4& value) override;
 
+				/**
+				 * <p>
+				 * Sets the features every variant drawn into the scene needs on top of its own (see
+				 * getBaseFeatures()). The OpenGLRenderingEngine sets these when its post processor changes.
+				 * </p>
+				 *
+				 * @param features The bitmask of Features.
+				 */
+				static void setBaseFeatures(unsigned int features);
+
+				/**
+				 * <p>
+				 * Sets the fixed-function state applied with the pipeline (and its variants).
+				 * </p>
+				 *
+				 * @param renderState The state, nullptr to use the default (see OpenGLRenderState::getDefault()).
+				 */
+				void setRenderState(std::shared_ptr<const OpenGLRenderState> renderState);
+
 			private:
+				/**
+				 * <p>
+				 * A program being linked to replace the current one.
+				 * </p>
+				 */
+				struct Reload
+				{
+					GLuint program;
+
+					std::unique_ptr<Shader> shaders[3];
+				};
+
 				std::unique_ptr<Shader> fragmentShader;
 
 				std::unique_ptr<Shader> geometryShader;
 
-				bool initialized;
+				OpenGLParameterBlock parameters;
+
+				/**
+				 * <p>
+				 * The name of the program the parameters were reflected from.
+				 * </p>
+				 */
+				GLuint parametersProgram;
+
+				std::unique_ptr<Reload> pendingReload;
+
+				std::shared_ptr<Program> program;
 
-				GLuint program;
+				std::shared_ptr<const OpenGLRenderState> renderState;
+
+				bool specializable;
+
+				std::map<unsigned int, std::unique_ptr<OpenGLPipeline>> variants;
 
 				std::unique_ptr<Shader> vertexShader;
 
+				void bindBuffer(const std::string& name, const Buffer& value, unsigned int offset, unsigned int size);
+
+				void bindUniformBlocks();
+
+				void finishLink();
+
+				static std::vector<std::string> getFeatureNames(unsigned int features);
+
+				bool hasFeatures() const;
+
+				bool isReloadReady() const;
+
+				void reflect();
+
+				void setParameter(const std::string& name, GLenum type, const void* data, unsigned int size);
+
+				void startReload(std::unique_ptr<Reload> reload);
+
 				void init();
 		};
 	}
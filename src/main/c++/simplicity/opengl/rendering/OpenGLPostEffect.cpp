@@ -0,0 +1,70 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include "../common/OpenGL.h"
+#include "OpenGLPipeline.h"
+#include "OpenGLPostEffect.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		OpenGLPostEffect::OpenGLPostEffect() :
+			vertexArray(0)
+		{
+		}
+
+		OpenGLPostEffect::~OpenGLPostEffect()
+		{
+			if (vertexArray != 0)
+			{
+				glDeleteVertexArrays(1, &vertexArray);
+				OpenGL::checkError();
+			}
+		}
+
+		void OpenGLPostEffect::bindTarget(OpenGLRenderingEngine& engine, FrameBuffer* target)
+		{
+			if (target == nullptr)
+			{
+				glBindFramebuffer(GL_FRAMEBUFFER, 0);
+				OpenGL::checkError();
+				glViewport(0, 0, engine.getWidth(), engine.getHeight());
+				OpenGL::checkError();
+			}
+			else
+			{
+				target->apply();
+			}
+		}
+
+		void OpenGLPostEffect::draw(const shared_ptr<Pipeline>& pipeline, const shared_ptr<Texture>& texture)
+		{
+			// The vertex array is empty but one still has to be bound to draw. It is created here rather than in the
+			// constructor because OpenGL might not be initialized then.
+			if (vertexArray == 0)
+			{
+				glGenVertexArrays(1, &vertexArray);
+				OpenGL::checkError();
+			}
+
+			static_pointer_cast<OpenGLPipeline>(pipeline)->flush();
+			texture->apply();
+
+			glBindVertexArray(vertexArray);
+			OpenGL::checkError();
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			OpenGL::checkError();
+		}
+	}
+}
@@ -0,0 +1,90 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLPOSTEFFECT_H_
+#define OPENGLPOSTEFFECT_H_
+
+#include <memory>
+
+#include <GL/glew.h>
+
+#include <simplicity/rendering/FrameBuffer.h>
+#include <simplicity/rendering/Pipeline.h>
+#include <simplicity/rendering/Texture.h>
+
+#include "OpenGLRenderingEngine.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * One effect in an OpenGLPostProcessingChain (e.g. bloom, tone mapping, anti-aliasing or color grading). An
+		 * effect reads the image produced by the effect before it and writes its own image to the target it is given.
+		 * </p>
+		 *
+		 * <p>
+		 * Any frame buffers an effect needs internally should be acquired from the OpenGLRenderTargetPool and released
+		 * again before process() returns, so that the effects in a chain share them.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLPostEffect
+		{
+			public:
+				OpenGLPostEffect();
+
+				virtual ~OpenGLPostEffect();
+
+				/**
+				 * <p>
+				 * Applies the effect.
+				 * </p>
+				 *
+				 * @param engine The engine the effect is applied for.
+				 * @param source The image to apply the effect to.
+				 * @param target The frame buffer to write the result to, nullptr for the default frame buffer.
+				 */
+				virtual void process(OpenGLRenderingEngine& engine, const std::shared_ptr<Texture>& source,
+						FrameBuffer* target) = 0;
+
+			protected:
+				/**
+				 * <p>
+				 * Binds a frame buffer to draw into, or the default frame buffer (at the size of the engine) if there
+				 * isn't one.
+				 * </p>
+				 *
+				 * @param engine The engine the effect is applied for.
+				 * @param target The frame buffer, can be nullptr.
+				 */
+				static void bindTarget(OpenGLRenderingEngine& engine, FrameBuffer* target);
+
+				/**
+				 * <p>
+				 * Draws a single triangle covering the whole target with a pipeline and a texture (bound to unit 0).
+				 * The vertices are generated in the vertex shader so the pipeline must use the "fullscreenTriangle"
+				 * vertex shader (see OpenGLRenderingFactory). The pipeline should be applied and its parameters set
+				 * before calling this.
+				 * </p>
+				 *
+				 * @param pipeline The pipeline.
+				 * @param texture The texture.
+				 */
+				void draw(const std::shared_ptr<Pipeline>& pipeline, const std::shared_ptr<Texture>& texture);
+
+			private:
+				GLuint vertexArray;
+		};
+	}
+}
+
+#endif /* OPENGLPOSTEFFECT_H_ */
@@ -0,0 +1,81 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include "OpenGLPostProcessingChain.h"
+#include "OpenGLRenderTargetPool.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		OpenGLPostProcessingChain::OpenGLPostProcessingChain() :
+			effects()
+		{
+		}
+
+		void OpenGLPostProcessingChain::add(unique_ptr<OpenGLPostEffect> effect)
+		{
+			effects.push_back(move(effect));
+		}
+
+		const vector<unique_ptr<OpenGLPostEffect>>& OpenGLPostProcessingChain::getEffects() const
+		{
+			return effects;
+		}
+
+		void OpenGLPostProcessingChain::process(RenderingEngine& engine)
+		{
+			OpenGLRenderingEngine& openGLEngine = static_cast<OpenGLRenderingEngine&>(engine);
+
+			shared_ptr<Texture> source = openGLEngine.getFrameBuffer()->getTextures()[0];
+			PixelFormat format = source->getPixelFormat();
+
+			unique_ptr<FrameBuffer> sourceFrameBuffer;
+			for (unsigned int index = 0; index < effects.size(); index++)
+			{
+				unique_ptr<FrameBuffer> target;
+				if (index < effects.size() - 1)
+				{
+					target = OpenGLRenderTargetPool::acquire(openGLEngine.getWidth(), openGLEngine.getHeight(),
+							format);
+				}
+
+				effects[index]->process(openGLEngine, source, target.get());
+
+				// Nothing reads the source again, the effect after next can draw into it.
+				OpenGLRenderTargetPool::release(move(sourceFrameBuffer));
+
+				if (target != nullptr)
+				{
+					source = target->getTextures()[0];
+					sourceFrameBuffer = move(target);
+				}
+			}
+		}
+
+		unique_ptr<OpenGLPostEffect> OpenGLPostProcessingChain::remove(const OpenGLPostEffect& effect)
+		{
+			for (auto existing = effects.begin(); existing != effects.end(); existing++)
+			{
+				if (existing->get() == &effect)
+				{
+					unique_ptr<OpenGLPostEffect> removed = move(*existing);
+					effects.erase(existing);
+					return removed;
+				}
+			}
+
+			return nullptr;
+		}
+	}
+}
@@ -0,0 +1,78 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLPOSTPROCESSINGCHAIN_H_
+#define OPENGLPOSTPROCESSINGCHAIN_H_
+
+#include <memory>
+#include <vector>
+
+#include <simplicity/rendering/PostProcessor.h>
+
+#include "OpenGLPostEffect.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Applies a list of effects in order, each one to the image produced by the one before it. The first effect
+		 * reads the color output of the engine's frame buffer and the last effect writes to the default frame buffer.
+		 * </p>
+		 *
+		 * <p>
+		 * The images between the effects are drawn into frame buffers from the OpenGLRenderTargetPool. Each one is
+		 * given back to the pool as soon as the effect after it has read it, so the next effect but one draws into
+		 * the same memory. Together with effects releasing their own frame buffers before they return, this means the
+		 * memory used for post processing depends on the most any one effect needs at once rather than on the number
+		 * of effects.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLPostProcessingChain : public PostProcessor
+		{
+			public:
+				OpenGLPostProcessingChain();
+
+				/**
+				 * <p>
+				 * Adds an effect to the end of the chain.
+				 * </p>
+				 *
+				 * @param effect The effect.
+				 */
+				void add(std::unique_ptr<OpenGLPostEffect> effect);
+
+				/**
+				 * @return The effects, in the order they are applied.
+				 */
+				const std::vector<std::unique_ptr<OpenGLPostEffect>>& getEffects() const;
+
+				void process(RenderingEngine& engine) override;
+
+				/**
+				 * <p>
+				 * Removes an effect from the chain.
+				 * </p>
+				 *
+				 * @param effect The effect.
+				 *
+				 * @return The removed effect or nullptr if it was not in the chain.
+				 */
+				std::unique_ptr<OpenGLPostEffect> remove(const OpenGLPostEffect& effect);
+
+			private:
+				std::vector<std::unique_ptr<OpenGLPostEffect>> effects;
+		};
+	}
+}
+
+#endif /* OPENGLPOSTPROCESSINGCHAIN_H_ */
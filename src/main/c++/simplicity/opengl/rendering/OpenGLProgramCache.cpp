@@ -0,0 +1,280 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <fstream>
+
+#include <simplicity/logging/Logs.h>
+
+#include "../common/Hash.h"
+#include "../common/MappedFile.h"
+#include "../common/OpenGL.h"
+#include "OpenGLProgramCache.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace OpenGLProgramCache
+		{
+			namespace
+			{
+				const char MAGIC[4] = { 'S', 'P', 'B', 'C' };
+
+				const uint32_t VERSION = 1;
+
+				struct FileHeader
+				{
+					char magic[4];
+
+					uint32_t version;
+
+					uint32_t binaryFormat;
+
+					uint32_t length;
+				};
+
+				string directory;
+
+				Statistics statistics;
+
+				string getPath(uint64_t key)
+				{
+					char fileName[32];
+					snprintf(fileName, sizeof(fileName), "%016llx.spc", static_cast<unsigned long long>(key));
+
+					return directory + "/" + fileName;
+				}
+
+				bool isSupported()
+				{
+					static bool checked = false;
+					static bool supported = false;
+
+					if (!checked)
+					{
+						if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+						{
+							GLint formatCount = 0;
+							glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+							OpenGL::checkError();
+
+							supported = formatCount > 0;
+						}
+
+						checked = true;
+					}
+
+					return supported;
+				}
+
+				double millisecondsSince(chrono::steady_clock::time_point start)
+				{
+					return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+				}
+			}
+
+			Statistics::Statistics() :
+				compileTime(0.0),
+				hits(0),
+				loadTime(0.0),
+				misses(0),
+				rejections(0),
+				stores(0),
+				timedCompiles(0)
+			{
+			}
+
+			double Statistics::getHitRate() const
+			{
+				if (hits + misses == 0)
+				{
+					return 0.0;
+				}
+
+				return static_cast<double>(hits) / (hits + misses);
+			}
+
+			double Statistics::getTimeSaved() const
+			{
+				if (timedCompiles == 0)
+				{
+					return 0.0;
+				}
+
+				return compileTime / timedCompiles * hits - loadTime;
+			}
+
+			uint64_t createKey(const vector<string>& sources)
+			{
+				// A binary is only valid for the driver that produced it.
+				uint64_t key = 0;
+				for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+				{
+					const char* value = reinterpret_cast<const char*>(glGetString(name));
+					if (value != nullptr)
+					{
+						key = Hash::fnv1a(value, strlen(value), key);
+					}
+				}
+
+				for (const string& source : sources)
+				{
+					key = Hash::fnv1a(source, key);
+				}
+
+				return key;
+			}
+
+			const string& getDirectory()
+			{
+				return directory;
+			}
+
+			Statistics getStatistics()
+			{
+				return statistics;
+			}
+
+			bool isEnabled()
+			{
+				return !directory.empty() && isSupported();
+			}
+
+			bool load(uint64_t key, GLuint program)
+			{
+				if (!isEnabled())
+				{
+					return false;
+				}
+
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+				MappedFile file(getPath(key));
+				if (!file.isOpen() || file.getSize() < sizeof(FileHeader))
+				{
+					statistics.misses++;
+					return false;
+				}
+
+				const FileHeader* header = reinterpret_cast<const FileHeader*>(file.getData());
+				if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+					file.getSize() - sizeof(FileHeader) < header->length)
+				{
+					statistics.misses++;
+					return false;
+				}
+
+				glProgramBinary(program, header->binaryFormat, header + 1, header->length);
+
+				// The driver is free to reject a binary (e.g. after it has been updated), which is reported as a link
+				// failure rather than an error.
+				glGetError();
+
+				GLint linkStatus = 0;
+				glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+				OpenGL::checkError();
+
+				if (linkStatus == 0)
+				{
+					statistics.misses++;
+					statistics.rejections++;
+					return false;
+				}
+
+				statistics.hits++;
+				statistics.loadTime += millisecondsSince(start);
+
+				return true;
+			}
+
+			void logReport()
+			{
+				Logs::info("simplicity::opengl", "Program cache: %u hits, %u misses (%.1f%% hit rate), %u rejected, "
+						"%u stored", statistics.hits, statistics.misses, statistics.getHitRate() * 100.0,
+						statistics.rejections, statistics.stores);
+				Logs::info("simplicity::opengl", "Program cache: %.1fms spent compiling, %.1fms spent loading, "
+						"~%.1fms saved", statistics.compileTime, statistics.loadTime, statistics.getTimeSaved());
+			}
+
+			void recordCompileTime(double milliseconds)
+			{
+				statistics.compileTime += milliseconds;
+				statistics.timedCompiles++;
+			}
+
+			void setDirectory(const string& directory)
+			{
+				OpenGLProgramCache::directory = directory;
+			}
+
+			void store(uint64_t key, GLuint program)
+			{
+				if (!isEnabled())
+				{
+					return;
+				}
+
+				GLint length = 0;
+				glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+				OpenGL::checkError();
+
+				if (length <= 0)
+				{
+					return;
+				}
+
+				FileHeader header;
+				memcpy(header.magic, MAGIC, sizeof(MAGIC));
+				header.version = VERSION;
+
+				vector<char> binary(length);
+				GLenum binaryFormat = 0;
+				glGetProgramBinary(program, length, nullptr, &binaryFormat, binary.data());
+				OpenGL::checkError();
+
+				header.binaryFormat = binaryFormat;
+				header.length = static_cast<uint32_t>(length);
+
+				// Write to a temporary file first so a crash can never leave a partial entry behind.
+				string path = getPath(key);
+				string temporaryPath = path + ".tmp";
+				{
+					ofstream file(temporaryPath, ios::binary | ios::trunc);
+					file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+					file.write(binary.data(), binary.size());
+
+					if (!file)
+					{
+						Logs::warning("simplicity::opengl", "Failed to write program cache entry %s", path.c_str());
+						remove(temporaryPath.c_str());
+						return;
+					}
+				}
+
+				remove(path.c_str());
+				if (rename(temporaryPath.c_str(), path.c_str()) != 0)
+				{
+					Logs::warning("simplicity::opengl", "Failed to write program cache entry %s", path.c_str());
+					remove(temporaryPath.c_str());
+					return;
+				}
+
+				statistics.stores++;
+			}
+		}
+	}
+}
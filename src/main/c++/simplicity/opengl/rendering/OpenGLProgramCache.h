@@ -0,0 +1,153 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLPROGRAMCACHE_H_
+#define OPENGLPROGRAMCACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * An on disk cache of linked program binaries (glGetProgramBinary), keyed by a hash of the shader sources and
+		 * the driver that produced the binary. The cache is disabled until a directory is set, and is never used if
+		 * the driver doesn't support program binaries.
+		 * </p>
+		 */
+		namespace OpenGLProgramCache
+		{
+			/**
+			 * <p>
+			 * Cache statistics.
+			 * </p>
+			 */
+			struct SIMPLE_API Statistics
+			{
+				Statistics();
+
+				/**
+				 * <p>
+				 * The total time spent compiling and linking programs that were not in the cache, in milliseconds.
+				 * Only the time the application was blocked on the driver is included, programs compiled on the
+				 * driver's own threads (GL_KHR_parallel_shader_compile) are not timed.
+				 * </p>
+				 */
+				double compileTime;
+
+				unsigned int hits;
+
+				/**
+				 * <p>
+				 * The total time spent loading programs from the cache, in milliseconds.
+				 * </p>
+				 */
+				double loadTime;
+
+				unsigned int misses;
+
+				/**
+				 * <p>
+				 * Cached binaries the driver refused to load (e.g. after a driver update).
+				 * </p>
+				 */
+				unsigned int rejections;
+
+				unsigned int stores;
+
+				/**
+				 * <p>
+				 * The number of programs whose compile time is included in compileTime.
+				 * </p>
+				 */
+				unsigned int timedCompiles;
+
+				/**
+				 * @return The fraction of lookups that were found in the cache.
+				 */
+				double getHitRate() const;
+
+				/**
+				 * @return The estimated time saved by loading programs from the cache, in milliseconds.
+				 */
+				double getTimeSaved() const;
+			};
+
+			/**
+			 * <p>
+			 * Creates the key of a program from its shader sources, the driver is included automatically.
+			 * </p>
+			 */
+			SIMPLE_API std::uint64_t createKey(const std::vector<std::string>& sources);
+
+			/**
+			 * @return The directory the cache is stored in, empty if the cache is disabled.
+			 */
+			SIMPLE_API const std::string& getDirectory();
+
+			SIMPLE_API Statistics getStatistics();
+
+			/**
+			 * @return True if a directory has been set and the driver supports program binaries, false otherwise.
+			 */
+			SIMPLE_API bool isEnabled();
+
+			/**
+			 * <p>
+			 * Attempts to load a program from the cache.
+			 * </p>
+			 *
+			 * @param key The key of the program.
+			 * @param program The program to load the binary into.
+			 *
+			 * @return True if the program was loaded and linked successfully, false otherwise.
+			 */
+			SIMPLE_API bool load(std::uint64_t key, GLuint program);
+
+			/**
+			 * <p>
+			 * Logs the hit rate and time saved.
+			 * </p>
+			 */
+			SIMPLE_API void logReport();
+
+			/**
+			 * <p>
+			 * Records the time it took to compile and link a program that was not in the cache.
+			 * </p>
+			 */
+			SIMPLE_API void recordCompileTime(double milliseconds);
+
+			/**
+			 * @param directory The (existing) directory to store the cache in, empty to disable the cache.
+			 */
+			SIMPLE_API void setDirectory(const std::string& directory);
+
+			/**
+			 * <p>
+			 * Stores a linked program in the cache. The program should have been linked with
+			 * GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+			 * </p>
+			 */
+			SIMPLE_API void store(std::uint64_t key, GLuint program);
+		}
+	}
+}
+
+#endif /* OPENGLPROGRAMCACHE_H_ */
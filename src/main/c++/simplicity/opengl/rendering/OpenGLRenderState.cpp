@@ -0,0 +1,245 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include "../common/OpenGL.h"
+#include "OpenGLRenderState.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace
+		{
+			OpenGLRenderState::Description current;
+
+			bool currentKnown = false;
+
+			shared_ptr<const OpenGLRenderState> defaultState;
+
+			// The scissor test of the state last applied, before it was forced on.
+			bool requestedScissorTest = false;
+
+			bool scissorTestForced = false;
+
+			unsigned int stateChanges = 0;
+
+			void setEnabled(GLenum capability, bool enabled)
+			{
+				if (enabled)
+				{
+					glEnable(capability);
+				}
+				else
+				{
+					glDisable(capability);
+				}
+				OpenGL::checkError();
+
+				stateChanges++;
+			}
+		}
+
+		OpenGLRenderState::OpenGLRenderState(const Description& description) :
+			description(description)
+		{
+		}
+
+		void OpenGLRenderState::apply() const
+		{
+			bool all = !currentKnown;
+
+			if (all || description.blend != current.blend)
+			{
+				setEnabled(GL_BLEND, description.blend);
+			}
+
+			if (all || description.blendSource != current.blendSource ||
+				description.blendDestination != current.blendDestination)
+			{
+				glBlendFunc(description.blendSource, description.blendDestination);
+				OpenGL::checkError();
+				stateChanges++;
+			}
+
+			if (all || description.colorWrite != current.colorWrite)
+			{
+				GLboolean colorWrite = description.colorWrite ? GL_TRUE : GL_FALSE;
+				glColorMask(colorWrite, colorWrite, colorWrite, colorWrite);
+				OpenGL::checkError();
+				stateChanges++;
+			}
+
+			if (all || description.cullFace != current.cullFace)
+			{
+				setEnabled(GL_CULL_FACE, description.cullFace);
+			}
+
+			if (all || description.cullFaceMode != current.cullFaceMode)
+			{
+				glCullFace(description.cullFaceMode);
+				OpenGL::checkError();
+				stateChanges++;
+			}
+
+			if (all || description.depthTest != current.depthTest)
+			{
+				setEnabled(GL_DEPTH_TEST, description.depthTest);
+			}
+
+			if (all || description.depthFunction != current.depthFunction)
+			{
+				glDepthFunc(description.depthFunction);
+				OpenGL::checkError();
+				stateChanges++;
+			}
+
+			if (all || description.depthWrite != current.depthWrite)
+			{
+				glDepthMask(description.depthWrite ? GL_TRUE : GL_FALSE);
+				OpenGL::checkError();
+				stateChanges++;
+			}
+
+			bool scissorTest = description.scissorTest || scissorTestForced;
+			if (all || scissorTest != current.scissorTest)
+			{
+				setEnabled(GL_SCISSOR_TEST, scissorTest);
+			}
+
+			current = description;
+			current.scissorTest = scissorTest;
+			currentKnown = true;
+			requestedScissorTest = description.scissorTest;
+		}
+
+		const OpenGLRenderState::Description& OpenGLRenderState::getCurrent()
+		{
+			return current;
+		}
+
+		shared_ptr<const OpenGLRenderState> OpenGLRenderState::getDefault()
+		{
+			return defaultState;
+		}
+
+		const OpenGLRenderState::Description& OpenGLRenderState::getDescription() const
+		{
+			return description;
+		}
+
+		const OpenGLRenderState& OpenGLRenderState::getOpaque()
+		{
+			static OpenGLRenderState opaque = []
+			{
+				Description description;
+				description.cullFace = true;
+				description.depthFunction = GL_LEQUAL;
+				description.depthTest = true;
+
+				return OpenGLRenderState(description);
+			}();
+
+			return opaque;
+		}
+
+		const OpenGLRenderState& OpenGLRenderState::getOpenGLDefaults()
+		{
+			static OpenGLRenderState defaults = OpenGLRenderState(Description());
+
+			return defaults;
+		}
+
+		const OpenGLRenderState& OpenGLRenderState::getPostProcess()
+		{
+			static OpenGLRenderState postProcess = []
+			{
+				Description description;
+				description.depthWrite = false;
+
+				return OpenGLRenderState(description);
+			}();
+
+			return postProcess;
+		}
+
+		unsigned int OpenGLRenderState::getStateChanges()
+		{
+			return stateChanges;
+		}
+
+		const OpenGLRenderState& OpenGLRenderState::getTransparent()
+		{
+			static OpenGLRenderState transparent = []
+			{
+				Description description = getOpaque().getDescription();
+				description.blend = true;
+				description.blendDestination = GL_ONE_MINUS_SRC_ALPHA;
+				description.blendSource = GL_SRC_ALPHA;
+
+				return OpenGLRenderState(description);
+			}();
+
+			return transparent;
+		}
+
+		void OpenGLRenderState::invalidate()
+		{
+			currentKnown = false;
+		}
+
+		bool OpenGLRenderState::isScissorTestForced()
+		{
+			return scissorTestForced;
+		}
+
+		void OpenGLRenderState::setDefault(shared_ptr<const OpenGLRenderState> state)
+		{
+			defaultState = state;
+		}
+
+		void OpenGLRenderState::setScissorTestForced(bool forced)
+		{
+			scissorTestForced = forced;
+
+			// Otherwise the next render state applied is applied in full anyway.
+			bool scissorTest = requestedScissorTest || forced;
+			if (currentKnown && scissorTest != current.scissorTest)
+			{
+				setEnabled(GL_SCISSOR_TEST, scissorTest);
+				current.scissorTest = scissorTest;
+			}
+		}
+
+		OpenGLRenderState::Description::Description() :
+			blend(false),
+			blendDestination(GL_ZERO),
+			blendSource(GL_ONE),
+			colorWrite(true),
+			cullFace(false),
+			cullFaceMode(GL_BACK),
+			depthFunction(GL_LESS),
+			depthTest(false),
+			depthWrite(true),
+			scissorTest(false)
+		{
+		}
+
+		bool OpenGLRenderState::Description::operator==(const Description& other) const
+		{
+			return blend == other.blend && blendDestination == other.blendDestination &&
+					blendSource == other.blendSource && colorWrite == other.colorWrite && cullFace == other.cullFace &&
+					cullFaceMode == other.cullFaceMode && depthFunction == other.depthFunction &&
+					depthTest == other.depthTest && depthWrite == other.depthWrite && scissorTest == other.scissorTest;
+		}
+	}
+}
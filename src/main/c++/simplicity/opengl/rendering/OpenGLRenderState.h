@@ -0,0 +1,158 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLRENDERSTATE_H_
+#define OPENGLRENDERSTATE_H_
+
+#include <memory>
+
+#include <GL/glew.h>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * An immutable set of fixed-function state (blending, color writes, depth testing, face culling and scissor
+		 * testing) that can be attached to a pipeline or used by a pass.
+		 * </p>
+		 *
+		 * <p>
+		 * The state last applied is shadowed, applying a render state only calls OpenGL for the parts that differ from
+		 * it. Code that changes this state directly has to call invalidate() so the next render state is applied in
+		 * full.
+		 * </p>
+		 * <p>
+		 * The scissor test can be forced on (see setScissorTestForced()), e.g. by a renderer, on top of whichever
+		 * render states are applied in the meantime.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLRenderState
+		{
+			public:
+				/**
+				 * <p>
+				 * The state itself. A default constructed description matches OpenGL's initial state.
+				 * </p>
+				 */
+				struct SIMPLE_API Description
+				{
+					Description();
+
+					bool operator==(const Description& other) const;
+
+					bool blend;
+
+					GLenum blendDestination;
+
+					GLenum blendSource;
+
+					bool colorWrite;
+
+					bool cullFace;
+
+					GLenum cullFaceMode;
+
+					GLenum depthFunction;
+
+					bool depthTest;
+
+					bool depthWrite;
+
+					bool scissorTest;
+				};
+
+				/**
+				 * @param description The state.
+				 */
+				explicit OpenGLRenderState(const Description& description);
+
+				/**
+				 * <p>
+				 * Applies the parts of this state that differ from the state last applied.
+				 * </p>
+				 */
+				void apply() const;
+
+				/**
+				 * @return The state last applied.
+				 */
+				static const Description& getCurrent();
+
+				/**
+				 * @return The state applied by pipelines that do not have their own.
+				 */
+				static std::shared_ptr<const OpenGLRenderState> getDefault();
+
+				const Description& getDescription() const;
+
+				/**
+				 * @return Depth tested and back face culled without blending, for opaque geometry.
+				 */
+				static const OpenGLRenderState& getOpaque();
+
+				/**
+				 * @return OpenGL's initial state.
+				 */
+				static const OpenGLRenderState& getOpenGLDefaults();
+
+				/**
+				 * @return No depth testing, culling or blending, for full screen passes.
+				 */
+				static const OpenGLRenderState& getPostProcess();
+
+				/**
+				 * @return The number of OpenGL state changes made by applying render states so far.
+				 */
+				static unsigned int getStateChanges();
+
+				/**
+				 * @return Depth tested and back face culled with alpha blending, for transparent geometry.
+				 */
+				static const OpenGLRenderState& getTransparent();
+
+				/**
+				 * <p>
+				 * Forgets the state last applied so the next render state is applied in full.
+				 * </p>
+				 */
+				static void invalidate();
+
+				/**
+				 * @return True if the scissor test is forced on, false otherwise.
+				 */
+				static bool isScissorTestForced();
+
+				/**
+				 * @param state The state applied by pipelines that do not have their own.
+				 */
+				static void setDefault(std::shared_ptr<const OpenGLRenderState> state);
+
+				/**
+				 * <p>
+				 * Forces the scissor test on regardless of the render states applied, or stops forcing it so the render
+				 * states decide again. Takes effect straight away.
+				 * </p>
+				 *
+				 * @param forced True to force the scissor test on, false to stop forcing it.
+				 */
+				static void setScissorTestForced(bool forced);
+
+			private:
+				Description description;
+		};
+	}
+}
+
+#endif /* OPENGLRENDERSTATE_H_ */
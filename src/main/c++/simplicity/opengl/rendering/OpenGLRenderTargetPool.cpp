@@ -0,0 +1,180 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <map>
+#include <vector>
+
+#include <simplicity/logging/Logs.h>
+#include <simplicity/rendering/RenderingFactory.h>
+
+#include "OpenGLFrameBuffer.h"
+#include "OpenGLRenderTargetPool.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace OpenGLRenderTargetPool
+		{
+			namespace
+			{
+				struct Description
+				{
+					PixelFormat format;
+
+					bool hasDepth;
+
+					unsigned int height;
+
+					unsigned int width;
+				};
+
+				struct Entry
+				{
+					Description description;
+
+					unique_ptr<FrameBuffer> frameBuffer;
+
+					unsigned long lastUsedFrame;
+				};
+
+				// The frame buffers that have been handed out, so we know what they are when they come back.
+				map<const FrameBuffer*, Description> acquired;
+
+				unsigned long currentFrame = 0;
+
+				vector<Entry> idle;
+
+				unsigned int maxIdleFrames = 60;
+
+				Statistics statistics;
+			}
+
+			unique_ptr<FrameBuffer> acquire(unsigned int width, unsigned int height, PixelFormat format, bool hasDepth)
+			{
+				Description description;
+				description.format = format;
+				description.hasDepth = hasDepth;
+				description.height = height;
+				description.width = width;
+
+				// Prefer a frame buffer of the same size, otherwise settle for one we can reallocate.
+				auto candidate = idle.end();
+				for (auto entry = idle.begin(); entry != idle.end(); entry++)
+				{
+					if (entry->description.format != format || entry->description.hasDepth != hasDepth)
+					{
+						continue;
+					}
+
+					candidate = entry;
+					if (entry->description.width == width && entry->description.height == height)
+					{
+						break;
+					}
+				}
+
+				unique_ptr<FrameBuffer> frameBuffer;
+				if (candidate != idle.end())
+				{
+					if (candidate->description.width == width && candidate->description.height == height)
+					{
+						statistics.reuses++;
+					}
+					else
+					{
+						static_cast<OpenGLFrameBuffer&>(*candidate->frameBuffer).resize(width, height);
+						statistics.reallocations++;
+					}
+
+					frameBuffer = move(candidate->frameBuffer);
+					idle.erase(candidate);
+				}
+				else
+				{
+					frameBuffer = RenderingFactory::createFrameBuffer(
+							{
+									RenderingFactory::createTexture(nullptr, width, height, format)
+							},
+							hasDepth);
+					statistics.creations++;
+				}
+
+				acquired[frameBuffer.get()] = description;
+
+				return frameBuffer;
+			}
+
+			void clear()
+			{
+				idle.clear();
+			}
+
+			unsigned int getMaxIdleFrames()
+			{
+				return maxIdleFrames;
+			}
+
+			Statistics getStatistics()
+			{
+				return statistics;
+			}
+
+			void nextFrame()
+			{
+				currentFrame++;
+
+				for (auto entry = idle.begin(); entry != idle.end();)
+				{
+					if (currentFrame - entry->lastUsedFrame > maxIdleFrames)
+					{
+						entry = idle.erase(entry);
+						statistics.destructions++;
+					}
+					else
+					{
+						entry++;
+					}
+				}
+			}
+
+			void release(unique_ptr<FrameBuffer> frameBuffer)
+			{
+				if (frameBuffer == nullptr)
+				{
+					return;
+				}
+
+				auto description = acquired.find(frameBuffer.get());
+				if (description == acquired.end())
+				{
+					Logs::error("simplicity::opengl", "Released a frame buffer that did not come from the pool");
+					return;
+				}
+
+				Entry entry;
+				entry.description = description->second;
+				entry.frameBuffer = move(frameBuffer);
+				entry.lastUsedFrame = currentFrame;
+				idle.push_back(move(entry));
+
+				acquired.erase(description);
+			}
+
+			void setMaxIdleFrames(unsigned int frames)
+			{
+				maxIdleFrames = frames;
+			}
+		}
+	}
+}
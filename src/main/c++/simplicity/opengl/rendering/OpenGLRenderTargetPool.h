@@ -0,0 +1,128 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLRENDERTARGETPOOL_H_
+#define OPENGLRENDERTARGETPOOL_H_
+
+#include <memory>
+
+#include <simplicity/rendering/FrameBuffer.h>
+#include <simplicity/rendering/PixelFormat.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Hands out frame buffers with a single color texture for intermediate passes (e.g. post processing). Frame
+		 * buffers that are released go back into the pool and are handed out again to the next request for the same
+		 * pixel format. If the size differs the frame buffer is reallocated in place, so a resize does not create or
+		 * destroy any OpenGL objects.
+		 * </p>
+		 *
+		 * <p>
+		 * Frame buffers that sit in the pool unused for longer than the maximum idle frames are destroyed.
+		 * </p>
+		 */
+		namespace OpenGLRenderTargetPool
+		{
+			/**
+			 * <p>
+			 * A count of the requests the pool has served.
+			 * </p>
+			 */
+			struct SIMPLE_API Statistics
+			{
+				/**
+				 * <p>
+				 * The number of frame buffers created.
+				 * </p>
+				 */
+				unsigned int creations = 0;
+
+				/**
+				 * <p>
+				 * The number of frame buffers destroyed after sitting idle.
+				 * </p>
+				 */
+				unsigned int destructions = 0;
+
+				/**
+				 * <p>
+				 * The number of requests served by a pooled frame buffer of a different size.
+				 * </p>
+				 */
+				unsigned int reallocations = 0;
+
+				/**
+				 * <p>
+				 * The number of requests served by a pooled frame buffer of the same size.
+				 * </p>
+				 */
+				unsigned int reuses = 0;
+			};
+
+			/**
+			 * <p>
+			 * Retrieves a frame buffer from the pool, creating one if there are none available.
+			 * </p>
+			 *
+			 * @param width The width of the frame buffer.
+			 * @param height The height of the frame buffer.
+			 * @param format The pixel format of the frame buffer's texture.
+			 * @param hasDepth Determines whether the frame buffer has a depth buffer.
+			 *
+			 * @return The frame buffer. It should be given back with release() when it is no longer needed.
+			 */
+			SIMPLE_API std::unique_ptr<FrameBuffer> acquire(unsigned int width, unsigned int height, PixelFormat format,
+					bool hasDepth = false);
+
+			/**
+			 * <p>
+			 * Destroys all the frame buffers in the pool.
+			 * </p>
+			 */
+			SIMPLE_API void clear();
+
+			/**
+			 * @return The number of frames a frame buffer can sit in the pool unused before it is destroyed.
+			 */
+			SIMPLE_API unsigned int getMaxIdleFrames();
+
+			SIMPLE_API Statistics getStatistics();
+
+			/**
+			 * <p>
+			 * Destroys the frame buffers that have sat in the pool unused for too long. Should be called once at the
+			 * start of each frame.
+			 * </p>
+			 */
+			SIMPLE_API void nextFrame();
+
+			/**
+			 * <p>
+			 * Gives a frame buffer back to the pool.
+			 * </p>
+			 *
+			 * @param frameBuffer The frame buffer, it must have been retrieved with acquire().
+			 */
+			SIMPLE_API void release(std::unique_ptr<FrameBuffer> frameBuffer);
+
+			/**
+			 * @param frames The number of frames a frame buffer can sit in the pool unused before it is destroyed.
+			 */
+			SIMPLE_API void setMaxIdleFrames(unsigned int frames);
+		}
+	}
+}
+
+#endif /* OPENGLRENDERTARGETPOOL_H_ */
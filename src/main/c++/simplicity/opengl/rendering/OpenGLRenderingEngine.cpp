@@ -16,6 +16,7 @@
  */
 #include <algorithm>
 
+#include <simplicity/logging/Logs.h>
 #include <simplicity/model/ModelFactory.h>
 #include <simplicity/rendering/RenderingFactory.h>
 #include <simplicity/resources/Resources.h>
@@ -23,7 +24,14 @@
 
 #include "../common/OpenGL.h"
 #include "../model/OpenGLMeshBuffer.h"
+#include "OpenGLFrameConstants.h"
+#include "OpenGLPipeline.h"
+#include "OpenGLRenderState.h"
+#include "OpenGLRenderTargetPool.h"
+#include "OpenGLShaderReloader.h"
 #include "OpenGLRenderingEngine.h"
+#include "OpenGLTextureManager.h"
+#include "OpenGLTextureReadback.h"
 
 using namespace std;
 
@@ -31,6 +39,11 @@ namespace simplicity
 {
 	namespace opengl
 	{
+		namespace
+		{
+			OpenGLRenderingEngine* deferringEngine = nullptr;
+		}
+
 		/* TODO MULTI DRAW!
 
 		// This needs to be small enough for the transform data to fit in the GLSL block as an array.
@@ -38,9 +51,18 @@ namespace simplicity
 		const unsigned int MAX_INSTANCES_PER_DRAW = 64;*/
 
 		OpenGLRenderingEngine::OpenGLRenderingEngine() :
+			deferredRenderLists(),
+			depthPrePass(false),
+			depthPrePassActive(false),
+			depthPrePassTimer(),
+			forwardTimer(),
 			frameBuffer(nullptr),
-			frameBufferChanged(false),
-			postProcessor(nullptr)
+			frameGraph(),
+			frameGraphSetup(),
+			pendingWarmUp(),
+			postProcessor(nullptr),
+			sceneReads(),
+			scenePassPending(false)
 		{
 			glewExperimental = GL_TRUE;
 			glewInit();
@@ -50,26 +72,107 @@ namespace simplicity
 			glGetError();
 		}
 
+		void OpenGLRenderingEngine::compileDefaultVariants()
+		{
+			unsigned int baseFeatures = OpenGLPipeline::getBaseFeatures();
+			vector<unsigned int> featureSets = {
+				baseFeatures | OpenGLPipeline::TEXTURED,
+				baseFeatures | OpenGLPipeline::VERTEX_COLOR
+			};
+
+			if (depthPrePass)
+			{
+				featureSets.push_back(OpenGLPipeline::DEPTH_ONLY);
+			}
+
+			// Warmed up pipelines are drawn with the same variants.
+			pendingWarmUp.setVariants(featureSets);
+
+			OpenGLPipeline* defaultPipeline = static_cast<OpenGLPipeline*>(getDefaultPipeline().get());
+			if (defaultPipeline == nullptr)
+			{
+				return;
+			}
+
+			// Get the variants the models will need compiling now rather than on the first frame they are drawn in.
+			defaultPipeline->compileVariants(featureSets);
+		}
+
+		void OpenGLRenderingEngine::declareFrameGraph()
+		{
+			frameGraph.clear();
+
+			OpenGLFrameGraph::TargetDescription screen;
+			screen.height = getHeight();
+			screen.width = getWidth();
+			OpenGLFrameGraph::Target screenTarget = frameGraph.importTarget("screen", nullptr, screen, true);
+
+			OpenGLFrameGraph::Target sceneTarget = screenTarget;
+			if (frameBuffer != nullptr)
+			{
+				const Texture& texture = *frameBuffer->getTextures()[0];
+				OpenGLFrameGraph::TargetDescription scene;
+				scene.format = texture.getPixelFormat();
+				scene.height = texture.getHeight();
+				scene.width = texture.getWidth();
+
+				// Without post processing whoever set the frame buffer reads it, so it is an output.
+				sceneTarget = frameGraph.importTarget("scene", frameBuffer.get(), scene, postProcessor == nullptr);
+			}
+
+			// Drawn by the renderers between preAdvance() and postAdvance().
+			frameGraph.addPass("scene", {}, sceneTarget, nullptr, true);
+
+			if (postProcessor != nullptr)
+			{
+				frameGraph.addPass("postProcessing", { sceneTarget }, screenTarget, [this]()
+				{
+					postProcessor->process(*this);
+				});
+			}
+
+			if (frameGraphSetup)
+			{
+				frameGraphSetup(frameGraph);
+			}
+
+			// The targets are looked up now that the setup function has declared its own.
+			for (const string& sceneRead : sceneReads)
+			{
+				OpenGLFrameGraph::Target target = frameGraph.getTarget(sceneRead);
+				if (target == OpenGLFrameGraph::NO_TARGET)
+				{
+					Logs::error("simplicity::opengl", "The scene pass reads %s but there is no such target",
+							sceneRead.data());
+					continue;
+				}
+
+				frameGraph.addRead("scene", target);
+			}
+		}
+
 		void OpenGLRenderingEngine::dispose()
 		{
-			// Revert blending settings.
-			glBlendFunc(GL_ONE, GL_ZERO);
-			OpenGL::checkError();
-			glDisable(GL_BLEND);
-			OpenGL::checkError();
+			if (deferringEngine == this)
+			{
+				deferringEngine = nullptr;
+			}
 
-			// Revert clearing settings.
-			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-			OpenGL::checkError();
+			// Nobody will complete outstanding texture reads once we're gone.
+			OpenGLTextureReadback::update(true);
 
-			// Revert depth test settings.
-			glDepthFunc(GL_LESS);
-			OpenGL::checkError();
-			glDisable(GL_DEPTH_TEST);
-			OpenGL::checkError();
+			OpenGLFrameConstants::dispose();
+			OpenGLRenderTargetPool::clear();
 
-			// Revert face culling settings.
-			glDisable(GL_CULL_FACE);
+			// Nothing will reload the watched pipelines once we're gone.
+			OpenGLShaderReloader::setEnabled(false);
+
+			// Revert blending, depth test, face culling and scissor settings.
+			OpenGLRenderState::getOpenGLDefaults().apply();
+			OpenGLRenderState::invalidate();
+
+			// Revert clearing settings.
+			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 			OpenGL::checkError();
 		}
 
@@ -131,11 +234,34 @@ namespace simplicity
 			//fence = nullptr;*/
 		}
 
+		void OpenGLRenderingEngine::flushDeferred()
+		{
+			if (deferringEngine != nullptr)
+			{
+				deferringEngine->renderDeferred();
+			}
+		}
+
 		FrameBuffer* OpenGLRenderingEngine::getFrameBuffer()
 		{
 			return frameBuffer.get();
 		}
 
+		OpenGLFrameGraph& OpenGLRenderingEngine::getFrameGraph()
+		{
+			return frameGraph;
+		}
+
+		double OpenGLRenderingEngine::getSceneGPUTime(bool depthPrePass) const
+		{
+			return depthPrePass ? depthPrePassTimer.getAverage() : forwardTimer.getAverage();
+		}
+
+		OpenGLWarmUp::Status OpenGLRenderingEngine::getWarmUpStatus() const
+		{
+			return pendingWarmUp.getStatus();
+		}
+
 		GLenum OpenGLRenderingEngine::getOpenGLDrawingMode(MeshBuffer::PrimitiveType primitiveType) const
 		{
 			if (primitiveType == MeshBuffer::PrimitiveType::POINTS)
@@ -164,23 +290,21 @@ namespace simplicity
 
 		void OpenGLRenderingEngine::init()
 		{
+			// Whatever happened to the OpenGL state before now, we did not do it through render states.
+			OpenGLRenderState::invalidate();
+
 			// Ensure objects further from the viewpoint are not drawn over the top of closer objects. To assist multi
 			// pass rendering, objects at the exact same distance can be rendered over (i.e. the object will be rendered
-			// using the result of the last Renderer executed).
-			glDepthFunc(GL_LEQUAL);
-			OpenGL::checkError();
-			glEnable(GL_DEPTH_TEST);
-			OpenGL::checkError();
-
-			// Only render the front (counter-clockwise) side of a polygon.
-			glEnable(GL_CULL_FACE);
-			OpenGL::checkError();
-
-			// Enable blending for rendering transparency.
-			glEnable(GL_BLEND);
-			OpenGL::checkError();
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			OpenGL::checkError();
+			// using the result of the last Renderer executed). Only render the front (counter-clockwise) side of a
+			// polygon and blend for rendering transparency. Pipelines for opaque geometry can use
+			// OpenGLRenderState::getOpaque() to skip blending.
+			if (OpenGLRenderState::getDefault() == nullptr)
+			{
+				shared_ptr<const OpenGLRenderState> transparent(
+						new OpenGLRenderState(OpenGLRenderState::getTransparent()));
+				OpenGLRenderState::setDefault(transparent);
+			}
+			OpenGLRenderState::getDefault()->apply();
 
 			if (getDefaultPipeline() == nullptr)
 			{
@@ -188,14 +312,50 @@ namespace simplicity
 				shared_ptr<Pipeline> defaultPipeline = RenderingFactory::createPipeline();
 				setDefaultPipeline(defaultPipeline);
 			}
+
+			compileDefaultVariants();
+		}
+
+		bool OpenGLRenderingEngine::isDepthPrePassEnabled() const
+		{
+			return depthPrePass;
+		}
+
+		void OpenGLRenderingEngine::logSceneGPUTimes() const
+		{
+			Logs::info("simplicity::opengl",
+					"Scene GPU time: forward %.3fms (%u frames), depth pre-pass %.3fms (%u frames)",
+					forwardTimer.getAverage(), forwardTimer.getSampleCount(), depthPrePassTimer.getAverage(),
+					depthPrePassTimer.getSampleCount());
 		}
 
 		void OpenGLRenderingEngine::postAdvance()
 		{
-			if (postProcessor != nullptr)
+			if (depthPrePassActive)
 			{
-				postProcessor->process(*this);
+				// Whatever was rendered since the last renderer finished (or without a renderer at all).
+				renderDeferred();
+				depthPrePassTimer.end();
 			}
+			else
+			{
+				forwardTimer.end();
+			}
+			depthPrePassActive = false;
+			deferringEngine = nullptr;
+
+			// Finish the scene pass and run the passes after it (e.g. post processing). If the scene pass was never
+			// reached the whole graph has already run this frame.
+			if (scenePassPending)
+			{
+				frameGraph.execute();
+				scenePassPending = false;
+			}
+
+			OpenGLShaderReloader::update();
+
+			// Hand over any texture reads the GPU has finished with since the last frame.
+			OpenGLTextureReadback::update();
 		}
 
 		bool OpenGLRenderingEngine::preAdvance()
@@ -207,53 +367,53 @@ namespace simplicity
 				return false;
 			}
 
-			if (frameBufferChanged || postProcessor != nullptr)
+			OpenGLFrameConstants::nextFrame();
+			OpenGLRenderTargetPool::nextFrame();
+			OpenGLTextureManager::nextFrame();
+
+			// Warming up can leave its own frame buffer bound, the frame graph binds the scene's below regardless.
+			pendingWarmUp.update();
+
+			// Clearing is affected by the depth mask and scissor test the last pass may have left behind.
+			if (OpenGLRenderState::getDefault() != nullptr)
 			{
-				if (frameBuffer == nullptr)
-				{
-					glBindFramebuffer(GL_FRAMEBUFFER, 0);
-					OpenGL::checkError();
-					glViewport(0, 0, getWidth(), getHeight());
-					OpenGL::checkError();
-				}
-				else
-				{
-					frameBuffer->apply();
-				}
+				OpenGLRenderState::getDefault()->apply();
+			}
+
+			declareFrameGraph();
 
-				frameBufferChanged = false;
+			// Run the passes up to the scene pass and bind its target, the renderers draw it once we return.
+			scenePassPending = frameGraph.execute();
+			if (!scenePassPending)
+			{
+				Logs::error("simplicity::opengl", "The frame graph ran to the end without reaching the scene pass");
 			}
 
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-			OpenGL::checkError();
+			depthPrePassActive = depthPrePass;
+			if (depthPrePassActive)
+			{
+				deferringEngine = this;
+				depthPrePassTimer.begin();
+			}
+			else
+			{
+				forwardTimer.begin();
+			}
 
 			return true;
 		}
 
 		void OpenGLRenderingEngine::render(const RenderList& renderList)
 		{
-			OpenGLMeshBuffer* openGLBuffer = static_cast<OpenGLMeshBuffer*>(renderList.buffer);
-			glBindVertexArray(openGLBuffer->getVAOName());
-			OpenGL::checkError();
-
-			for (const pair<Model*, Matrix44>& modelAndTransform : renderList.list)
+			if (depthPrePassActive)
 			{
-				const Model* model = modelAndTransform.first;
-
-				renderList.pipeline->set("worldTransform", modelAndTransform.second);
-
-				if (model->getTexture() != nullptr)
-				{
-					model->getTexture()->apply();
-					renderList.pipeline->set("sampler", 0);
-					renderList.pipeline->set("samplerEnabled", 1);
-				}
-
-				draw(*renderList.buffer, *model->getMesh());
-
-				renderList.pipeline->set("samplerEnabled", 0);
+				// Drawn at the end of the scene pass, once the depth of everything opaque is known.
+				deferredRenderLists.push_back(renderList);
+				return;
 			}
 
+			renderModels(renderList, true, nullptr);
+
 			/* TODO MULTI DRAW!
 
 			vector<int> counts;
@@ -307,15 +467,185 @@ namespace simplicity
 			draw(buffer, counts, baseIndexLocations, baseVertices);*/
 		}
 
+		void OpenGLRenderingEngine::renderDeferred()
+		{
+			// Pipelines without their own state use the default state.
+			auto getDescription = [](const RenderList& renderList)
+			{
+				OpenGLPipeline* pipeline = static_cast<OpenGLPipeline*>(renderList.pipeline);
+				shared_ptr<const OpenGLRenderState> renderState = pipeline->getRenderState();
+				if (renderState == nullptr)
+				{
+					renderState = OpenGLRenderState::getDefault();
+				}
+
+				return renderState == nullptr ? OpenGLRenderState::Description() : renderState->getDescription();
+			};
+
+			// Blended geometry (or geometry that leaves depth alone) must not hide what is behind it.
+			auto isOpaque = [](const OpenGLRenderState::Description& description)
+			{
+				return !description.blend && description.colorWrite && description.depthTest &&
+						description.depthWrite;
+			};
+
+			for (const RenderList& renderList : deferredRenderLists)
+			{
+				OpenGLRenderState::Description description = getDescription(renderList);
+				if (isOpaque(description))
+				{
+					description.colorWrite = false;
+					renderDepth(renderList, OpenGLRenderState(description));
+				}
+			}
+
+			for (const RenderList& renderList : deferredRenderLists)
+			{
+				OpenGLRenderState::Description description = getDescription(renderList);
+				if (isOpaque(description))
+				{
+					// Only the fragments that made it through the pre-pass are shaded.
+					description.depthFunction = GL_EQUAL;
+					description.depthWrite = false;
+
+					OpenGLRenderState renderState(description);
+					renderModels(renderList, false, &renderState);
+				}
+				else
+				{
+					renderModels(renderList, false, nullptr);
+				}
+			}
+
+			deferredRenderLists.clear();
+		}
+
+		void OpenGLRenderingEngine::renderDepth(const RenderList& renderList, const OpenGLRenderState& renderState)
+		{
+			OpenGLMeshBuffer* openGLBuffer = static_cast<OpenGLMeshBuffer*>(renderList.buffer);
+			glBindVertexArray(openGLBuffer->getVAOName());
+			OpenGL::checkError();
+
+			// Positions only, there are no textures or colors to switch between.
+			OpenGLPipeline& variant = static_cast<OpenGLPipeline*>(renderList.pipeline)->getVariant(
+					OpenGLPipeline::DEPTH_ONLY);
+			variant.apply();
+			renderState.apply();
+
+			bool hasWorldTransform = variant.getParameters().getParameter("worldTransform") != nullptr;
+			for (const pair<Model*, Matrix44>& modelAndTransform : renderList.list)
+			{
+				if (hasWorldTransform)
+				{
+					variant.set("worldTransform", modelAndTransform.second);
+				}
+
+				variant.flush();
+				draw(*renderList.buffer, *modelAndTransform.first->getMesh());
+			}
+		}
+
+		void OpenGLRenderingEngine::renderModels(const RenderList& renderList, bool pipelineApplied,
+				const OpenGLRenderState* renderState)
+		{
+			OpenGLMeshBuffer* openGLBuffer = static_cast<OpenGLMeshBuffer*>(renderList.buffer);
+			glBindVertexArray(openGLBuffer->getVAOName());
+			OpenGL::checkError();
+
+			// Switch to the variant each model needs as we go.
+			OpenGLPipeline* pipeline = static_cast<OpenGLPipeline*>(renderList.pipeline);
+			OpenGLPipeline* appliedPipeline = pipelineApplied ? pipeline : nullptr;
+			unsigned int baseFeatures = OpenGLPipeline::getBaseFeatures();
+
+			for (const pair<Model*, Matrix44>& modelAndTransform : renderList.list)
+			{
+				const Model* model = modelAndTransform.first;
+
+				unsigned int features = baseFeatures;
+				if (model->getTexture() != nullptr)
+				{
+					features |= OpenGLPipeline::TEXTURED;
+				}
+				else
+				{
+					features |= OpenGLPipeline::VERTEX_COLOR;
+				}
+
+				OpenGLPipeline& variant = pipeline->getVariant(features);
+				if (&variant != appliedPipeline)
+				{
+					variant.apply();
+					appliedPipeline = &variant;
+
+					if (renderState != nullptr)
+					{
+						renderState->apply();
+					}
+
+					if ((features & OpenGLPipeline::TEXTURED) != 0)
+					{
+						variant.set("sampler", 0);
+					}
+				}
+
+				// Full screen passes (e.g. post processing) have no world transform.
+				if (variant.getParameters().getParameter("worldTransform") != nullptr)
+				{
+					variant.set("worldTransform", modelAndTransform.second);
+				}
+
+				if (model->getTexture() != nullptr)
+				{
+					model->getTexture()->apply();
+				}
+
+				variant.flush();
+				draw(*renderList.buffer, *model->getMesh());
+			}
+		}
+
+		void OpenGLRenderingEngine::setDepthPrePassEnabled(bool depthPrePass)
+		{
+			this->depthPrePass = depthPrePass;
+
+			compileDefaultVariants();
+		}
+
 		void OpenGLRenderingEngine::setFrameBuffer(unique_ptr<FrameBuffer> frameBuffer)
 		{
 			this->frameBuffer = move(frameBuffer);
-			frameBufferChanged = true;
+		}
+
+		void OpenGLRenderingEngine::setFrameGraphSetup(function<void(OpenGLFrameGraph& frameGraph)> setup)
+		{
+			frameGraphSetup = setup;
 		}
 
 		void OpenGLRenderingEngine::setPostProcessor(std::unique_ptr<PostProcessor> postProcessor)
 		{
 			this->postProcessor = move(postProcessor);
+
+			// Everything drawn into the scene has to write the second output the post processor reads.
+			OpenGLPipeline::setBaseFeatures(this->postProcessor != nullptr ?
+					static_cast<unsigned int>(OpenGLPipeline::BLOOM_OUTPUT) : 0u);
+
+			compileDefaultVariants();
+		}
+
+		void OpenGLRenderingEngine::setSceneReads(const vector<string>& targets)
+		{
+			sceneReads = targets;
+		}
+
+		void OpenGLRenderingEngine::setWarmUpBudget(unsigned int frames, double milliseconds)
+		{
+			pendingWarmUp.setBudget(frames, milliseconds);
+		}
+
+		void OpenGLRenderingEngine::warmUp(const vector<shared_ptr<Pipeline>>& pipelines,
+				const vector<shared_ptr<Texture>>& textures, const vector<FrameBuffer*>& frameBuffers)
+		{
+			pendingWarmUp.add(pipelines, textures, frameBuffers);
 		}
 	}
 }
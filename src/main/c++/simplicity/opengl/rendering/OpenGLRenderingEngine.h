@@ -17,10 +17,17 @@
 #ifndef OPENGLRENDERINGENGINE_H_
 #define OPENGLRENDERINGENGINE_H_
 
+#include <functional>
+
 #include <GL/glew.h>
 
 #include <simplicity/rendering/AbstractRenderingEngine.h>
 
+#include "../common/OpenGLTimer.h"
+#include "OpenGLFrameGraph.h"
+#include "OpenGLRenderState.h"
+#include "OpenGLWarmUp.h"
+
 namespace simplicity
 {
 	namespace opengl
@@ -35,21 +42,153 @@ namespace simplicity
 			public:
 				OpenGLRenderingEngine();
 
+				/**
+				 * <p>
+				 * Draws the render lists collected for the depth pre-pass so far (see setDepthPrePassEnabled()), while
+				 * the camera, parameters, scissor and clears of the renderer that submitted them are still in effect.
+				 * Called by AbstractOpenGLRenderer at the end of each renderer's turn, it does nothing if there is no
+				 * depth pre-pass.
+				 * </p>
+				 */
+				static void flushDeferred();
+
 				FrameBuffer* getFrameBuffer() override;
 
+				/**
+				 * <p>
+				 * Retrieves the graph the passes of each frame are scheduled with. The engine declares a "scene" pass
+				 * (drawn by the renderers into the "scene" target, or the "screen" target if there is no frame
+				 * buffer) and a "postProcessing" pass (from the "scene" target to the "screen" target) if there is a
+				 * post processor. The scene pass is never culled and reads the targets set with setSceneReads().
+				 * </p>
+				 *
+				 * @return The frame graph.
+				 */
+				OpenGLFrameGraph& getFrameGraph();
+
+				/**
+				 * @param depthPrePass Determines whether to retrieve the time of frames drawn with a depth pre-pass or
+				 * without one.
+				 *
+				 * @return The average GPU time in milliseconds spent drawing the scene pass per frame so far.
+				 */
+				double getSceneGPUTime(bool depthPrePass) const;
+
+				/**
+				 * @return What is still cold from the pipelines, textures and frame buffers passed to warmUp().
+				 */
+				OpenGLWarmUp::Status getWarmUpStatus() const;
+
+				/**
+				 * @return True if the scene is drawn with a depth pre-pass, false otherwise.
+				 */
+				bool isDepthPrePassEnabled() const;
+
+				/**
+				 * <p>
+				 * Logs the GPU time spent drawing the scene with and without a depth pre-pass, for comparison.
+				 * </p>
+				 */
+				void logSceneGPUTimes() const;
+
 				void render(const RenderList& renderList) override;
 
+				/**
+				 * <p>
+				 * Sets whether the scene is drawn with a depth pre-pass, from the next frame on. The render lists of
+				 * the scene are collected rather than drawn straight away. At the end of each renderer's turn (see
+				 * flushDeferred()) and of the scene pass, the opaque ones (their pipelines test and write depth and do
+				 * not blend) are drawn with their pipelines' DEPTH_ONLY variants and color writes off. All of them are
+				 * then drawn as usual, the opaque ones with an equal depth test and depth writes off, so each pixel is
+				 * only shaded once.
+				 * </p>
+				 *
+				 * <p>
+				 * Vertex shaders of specialisable pipelines must declare gl_Position invariant so their variants
+				 * produce identical depth.
+				 * </p>
+				 *
+				 * @param depthPrePass Determines whether the scene is drawn with a depth pre-pass.
+				 */
+				void setDepthPrePassEnabled(bool depthPrePass);
+
 				void setFrameBuffer(std::unique_ptr<FrameBuffer> frameBuffer) override;
 
+				/**
+				 * <p>
+				 * Sets a function that declares additional passes in the frame graph. It is called every frame after
+				 * the engine has declared its own passes. All the additional passes must have execute functions.
+				 * </p>
+				 *
+				 * @param setup The function.
+				 */
+				void setFrameGraphSetup(std::function<void(OpenGLFrameGraph& frameGraph)> setup);
+
 				void setPostProcessor(std::unique_ptr<PostProcessor> postProcessor) override;
 
+				/**
+				 * <p>
+				 * Sets the targets the scene pass reads (e.g. a shadow map drawn by a pass declared in the frame graph
+				 * setup function) so that the passes writing them run before the scene is drawn.
+				 * </p>
+				 *
+				 * @param targets The names of the targets.
+				 */
+				void setSceneReads(const std::vector<std::string>& targets);
+
+				/**
+				 * <p>
+				 * Sets how warming up is spread over frames (see OpenGLWarmUp::setBudget()).
+				 * </p>
+				 *
+				 * @param frames The number of frames to spread the work over, 0 for no limit.
+				 * @param milliseconds The time to spend per frame, 0 for no limit.
+				 */
+				void setWarmUpBudget(unsigned int frames, double milliseconds);
+
+				/**
+				 * <p>
+				 * Initializes pipelines, textures and frame buffers over the next frames (at the start of each frame,
+				 * within the warm up budget) so that the frames that first use them do not hitch.
+				 * </p>
+				 *
+				 * @param pipelines The pipelines to compile and link.
+				 * @param textures The textures to upload.
+				 * @param frameBuffers The frame buffers to create, they must outlive the warm up.
+				 */
+				void warmUp(const std::vector<std::shared_ptr<Pipeline>>& pipelines,
+						const std::vector<std::shared_ptr<Texture>>& textures = {},
+						const std::vector<FrameBuffer*>& frameBuffers = {});
+
 			private:
+				std::vector<RenderList> deferredRenderLists;
+
+				bool depthPrePass;
+
+				bool depthPrePassActive;
+
+				OpenGLTimer depthPrePassTimer;
+
+				OpenGLTimer forwardTimer;
+
 				std::unique_ptr<FrameBuffer> frameBuffer;
 
-				bool frameBufferChanged;
+				OpenGLFrameGraph frameGraph;
+
+				std::function<void(OpenGLFrameGraph& frameGraph)> frameGraphSetup;
+
+				OpenGLWarmUp pendingWarmUp;
 
 				std::unique_ptr<PostProcessor> postProcessor;
 
+				std::vector<std::string> sceneReads;
+
+				bool scenePassPending;
+
+				void compileDefaultVariants();
+
+				void declareFrameGraph();
+
 				void dispose() override;
 
 				void draw(const MeshBuffer& buffer, const Mesh& mesh) const;
@@ -61,6 +200,13 @@ namespace simplicity
 				void postAdvance() override;
 
 				bool preAdvance() override;
+
+				void renderDeferred();
+
+				void renderDepth(const RenderList& renderList, const OpenGLRenderState& renderState);
+
+				void renderModels(const RenderList& renderList, bool pipelineApplied,
+						const OpenGLRenderState* renderState);
 		};
 	}
 }
@@ -14,6 +14,7 @@
  * You should have received a copy of the GNU General Public License along with The Simplicity Engine. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include "../common/Hash.h"
 #include "OpenGLFrameBuffer.h"
 #include "OpenGLPipeline.h"
 #include "OpenGLRenderingFactory.h"
@@ -27,6 +28,32 @@ namespace simplicity
 {
 	namespace opengl
 	{
+		namespace
+		{
+			uint64_t getShaderKey(Shader::Type type, const string& source)
+			{
+				return Hash::fnv1a(source, static_cast<uint64_t>(type) + 1);
+			}
+		}
+
+		void OpenGLRenderingFactory::clearCache()
+		{
+			programs.clear();
+			shaders.clear();
+		}
+
+		unique_ptr<OpenGLComputeProgram> OpenGLRenderingFactory::createComputeProgram(const string& name,
+				const vector<string>& defines)
+		{
+			if (name == "gaussianBlur")
+			{
+				return unique_ptr<OpenGLComputeProgram>(
+						new OpenGLComputeProgram(OpenGLShader::addDefines(ShaderSource::computeGaussianBlur, defines)));
+			}
+
+			return nullptr;
+		}
+
 		unique_ptr<FrameBuffer> OpenGLRenderingFactory::createFrameBufferInternal(vector<shared_ptr<Texture>> textures,
 																				  bool hasDepth)
 		{
@@ -51,13 +78,70 @@ namespace simplicity
 																			unique_ptr<Shader> geometryShader,
 																			unique_ptr<Shader> fragmentShader)
 		{
-			return shared_ptr<Pipeline>(new OpenGLPipeline(move(vertexShader), move(geometryShader),
-														   move(fragmentShader)));
+			// The pipeline key chains the keys of its shaders so the same sources in different stages do not collide.
+			uint64_t key = 0;
+			vector<string> sources;
+			for (Shader* shader : { vertexShader.get(), geometryShader.get(), fragmentShader.get() })
+			{
+				uint64_t shaderKey = 0;
+				string source;
+				if (shader != nullptr)
+				{
+					const OpenGLShader* openGLShader = static_cast<const OpenGLShader*>(shader);
+					shaderKey = getShaderKey(openGLShader->getType(), openGLShader->getSource());
+					source = openGLShader->getSource();
+				}
+
+				key = Hash::fnv1a(reinterpret_cast<const char*>(&shaderKey), sizeof(shaderKey), key);
+				sources.push_back(source);
+			}
+
+			// Every caller gets a pipeline of its own (with its own uniform values and render state), only the program
+			// is shared. The sources are compared too, a key collision must not hand out the wrong program.
+			auto cachedProgram = programs.find(key);
+			if (cachedProgram != programs.end() && cachedProgram->second.sources == sources)
+			{
+				shared_ptr<OpenGLPipeline::Program> program = cachedProgram->second.program.lock();
+				if (program != nullptr)
+				{
+					statistics.linksAvoided++;
+					return shared_ptr<Pipeline>(new OpenGLPipeline(move(vertexShader), move(geometryShader),
+							move(fragmentShader), program));
+				}
+			}
+
+			// Forget the programs no pipeline is using anymore.
+			for (auto program = programs.begin(); program != programs.end();)
+			{
+				if (program->second.program.expired())
+				{
+					program = programs.erase(program);
+				}
+				else
+				{
+					program++;
+				}
+			}
+
+			shared_ptr<OpenGLPipeline> pipeline(new OpenGLPipeline(move(vertexShader), move(geometryShader),
+																   move(fragmentShader)));
+			statistics.pipelinesCreated++;
+
+			// A colliding entry still in use keeps its place, the new program just goes uncached.
+			cachedProgram = programs.find(key);
+			if (cachedProgram == programs.end())
+			{
+				CachedProgram& entry = programs[key];
+				entry.program = pipeline->getProgram();
+				entry.sources = sources;
+			}
+
+			return pipeline;
 		}
 
 		unique_ptr<Shader> OpenGLRenderingFactory::createShaderInternal(Shader::Type type, const Resource& resource)
 		{
-			return unique_ptr<Shader>(new OpenGLShader(type, resource));
+			return getShader(type, resource.getData(), resource.getName());
 		}
 
 		unique_ptr<Shader> OpenGLRenderingFactory::createShaderInternal(Shader::Type type, const string& name)
@@ -66,20 +150,36 @@ namespace simplicity
 			{
 				if (name == "clip")
 				{
-					return unique_ptr<Shader>(new OpenGLShader(type, ShaderSource::vertexClip));
+					return getShader(type, ShaderSource::vertexClip);
+				}
+
+				if (name == "fullscreenTriangle")
+				{
+					return getShader(type,
+							OpenGLShader::addDefines(ShaderSource::vertexClip, { "FULLSCREEN_TRIANGLE" }));
 				}
 
 				if (name == "simple")
 				{
-					return unique_ptr<Shader>(new OpenGLShader(type, ShaderSource::vertexSimple));
+					return getShader(type, ShaderSource::vertexSimple);
 				}
 			}
 
 			if (type == Shader::Type::FRAGMENT)
 			{
+				if (name == "bloomDownsample")
+				{
+					return getShader(type, ShaderSource::fragmentBloomDownsample);
+				}
+
+				if (name == "bloomUpsample")
+				{
+					return getShader(type, ShaderSource::fragmentBloomUpsample);
+				}
+
 				if (name == "simple")
 				{
-					return unique_ptr<Shader>(new OpenGLShader(type, ShaderSource::fragmentSimple));
+					return getShader(type, ShaderSource::fragmentSimple);
 				}
 			}
 
@@ -102,5 +202,57 @@ namespace simplicity
 		{
 			return shared_ptr<Texture>(new OpenGLTexture(image, format));
 		}
+
+		const OpenGLRenderingFactory::CacheStatistics& OpenGLRenderingFactory::getCacheStatistics() const
+		{
+			return statistics;
+		}
+
+		unique_ptr<Shader> OpenGLRenderingFactory::getShader(Shader::Type type, const string& source,
+				const string& resourceName)
+		{
+			// Shaders from resources remember where they came from (so they can be reloaded), keep them apart.
+			uint64_t key = getShaderKey(type, source);
+			if (!resourceName.empty())
+			{
+				key = Hash::fnv1a(resourceName, key);
+			}
+
+			// The sources are compared too, a key collision must not hand out the wrong shader.
+			auto cachedShader = shaders.find(key);
+			bool collision = cachedShader != shaders.end() && (cachedShader->second->getType() != type ||
+					cachedShader->second->getSource() != source ||
+					cachedShader->second->getResourceName() != resourceName);
+			if (cachedShader != shaders.end() && !collision)
+			{
+				// A copy shares the OpenGL shader object so the source will only be compiled once.
+				if (cachedShader->second->isCompiled())
+				{
+					statistics.compilesAvoided++;
+				}
+
+				return unique_ptr<Shader>(new OpenGLShader(*cachedShader->second));
+			}
+
+			unique_ptr<OpenGLShader> shader(new OpenGLShader(type, source, resourceName));
+			statistics.shadersCreated++;
+			if (collision)
+			{
+				return move(shader);
+			}
+
+			unique_ptr<Shader> copy(new OpenGLShader(*shader));
+			shaders[key] = move(shader);
+
+			return copy;
+		}
+
+		OpenGLRenderingFactory::CacheStatistics::CacheStatistics() :
+			compilesAvoided(0),
+			linksAvoided(0),
+			pipelinesCreated(0),
+			shadersCreated(0)
+		{
+		}
 	}
 }
@@ -17,8 +17,15 @@
 #ifndef OPENGLRENDERINGFACTORY_H_
 #define OPENGLRENDERINGFACTORY_H_
 
+#include <cstdint>
+#include <map>
+
 #include <simplicity/rendering/RenderingFactory.h>
 
+#include "OpenGLComputeProgram.h"
+#include "OpenGLPipeline.h"
+#include "OpenGLShader.h"
+
 namespace simplicity
 {
 	namespace opengl
@@ -27,10 +34,67 @@ namespace simplicity
 		 * <p>
 		 * A factory that creates textures implemented using OpenGL.
 		 * </p>
+		 *
+		 * <p>
+		 * Shaders and programs are cached by their source. Asking for a shader that has been created before returns a
+		 * copy that shares the already compiled OpenGL shader, and asking for a pipeline made of shaders that have
+		 * been linked together before returns a new pipeline that shares the already linked OpenGL program. Programs
+		 * are only cached while a pipeline is using them.
+		 * </p>
 		 */
 		class SIMPLE_API OpenGLRenderingFactory : public RenderingFactory
 		{
 			public:
+				/**
+				 * <p>
+				 * Shader and pipeline cache statistics.
+				 * </p>
+				 */
+				struct SIMPLE_API CacheStatistics
+				{
+					CacheStatistics();
+
+					/**
+					 * <p>
+					 * Shaders that did not need compiling because an identical shader had been created before.
+					 * </p>
+					 */
+					unsigned int compilesAvoided;
+
+					/**
+					 * <p>
+					 * Pipelines that did not need linking because a pipeline made of the same shaders was still using
+					 * its program.
+					 * </p>
+					 */
+					unsigned int linksAvoided;
+
+					unsigned int pipelinesCreated;
+
+					unsigned int shadersCreated;
+				};
+
+				/**
+				 * <p>
+				 * Releases the cached shaders and forgets the cached programs (pipelines still using them keep them).
+				 * </p>
+				 */
+				void clearCache();
+
+				/**
+				 * <p>
+				 * Creates one of the built in compute programs. Compute programs are specific to OpenGL so they are not
+				 * cached or exposed through RenderingFactory.
+				 * </p>
+				 *
+				 * @param name The name of the program.
+				 * @param defines The preprocessor definitions to compile the program with.
+				 *
+				 * @return The program or nullptr if there is no built in program with the given name.
+				 */
+				static std::unique_ptr<OpenGLComputeProgram> createComputeProgram(const std::string& name,
+						const std::vector<std::string>& defines = {});
+
 				std::unique_ptr<FrameBuffer> createFrameBufferInternal(std::vector<std::shared_ptr<Texture>> textures,
 																	   bool hasDepth) override;
 
@@ -51,6 +115,30 @@ namespace simplicity
 															   PixelFormat format) override;
 
 				std::shared_ptr<Texture> createTextureInternal(Resource& image, PixelFormat format) override;
+
+				const CacheStatistics& getCacheStatistics() const;
+
+			private:
+				/**
+				 * <p>
+				 * A program and the sources it was linked from, to tell key collisions apart.
+				 * </p>
+				 */
+				struct CachedProgram
+				{
+					std::weak_ptr<OpenGLPipeline::Program> program;
+
+					std::vector<std::string> sources;
+				};
+
+				std::map<std::uint64_t, CachedProgram> programs;
+
+				std::map<std::uint64_t, std::unique_ptr<OpenGLShader>> shaders;
+
+				CacheStatistics statistics;
+
+				std::unique_ptr<Shader> getShader(Shader::Type type, const std::string& source,
+						const std::string& resourceName = std::string());
 		};
 	}
 }
@@ -14,6 +14,9 @@
  * You should have received a copy of the GNU General Public License along with The Simplicity Engine. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cctype>
+
 #include <simplicity/common/Category.h>
 #include <simplicity/logging/Logs.h>
 
@@ -27,14 +30,24 @@ namespace simplicity
 	namespace opengl
 	{
 		OpenGLShader::OpenGLShader(Type type, const Resource& source) :
-			shader(0),
+			object(new Object),
+			resourceName(source.getName()),
 			source(source.getData()),
 			type(type)
 		{
 		}
 
 		OpenGLShader::OpenGLShader(Type type, const string& source) :
-			shader(0),
+			object(new Object),
+			resourceName(),
+			source(source),
+			type(type)
+		{
+		}
+
+		OpenGLShader::OpenGLShader(Type type, const string& source, const string& resourceName) :
+			object(new Object),
+			resourceName(resourceName),
 			source(source),
 			type(type)
 		{
@@ -42,52 +55,215 @@ namespace simplicity
 
 		OpenGLShader::~OpenGLShader()
 		{
-			// TODO Clean up the shader?
 		}
 
-		GLuint OpenGLShader::getShader()
+		string OpenGLShader::addDefines(const string& source, const vector<string>& defines)
 		{
-			return shader;
+			string defineSource;
+			for (const string& define : defines)
+			{
+				defineSource += "#define " + define + "\n";
+			}
+
+			// The #version directive has to come first.
+			size_t position = 0;
+			if (source.compare(0, 8, "#version") == 0)
+			{
+				position = source.find('\n');
+				position = position == string::npos ? source.size() : position + 1;
+			}
+
+			string definedSource = source;
+			definedSource.insert(position, defineSource);
+
+			return definedSource;
 		}
 
-		void OpenGLShader::init()
+		bool OpenGLShader::checkCompileStatus()
 		{
+			// Only report the errors once for all the copies.
+			if (object->checked)
+			{
+				return object->valid;
+			}
+
+			GLint compileStatus;
+			glGetShaderiv(object->name, GL_COMPILE_STATUS, &compileStatus);
+			OpenGL::checkError();
+
+			if (compileStatus == 0)
+			{
+				GLchar infoLog[1024];
+				glGetShaderInfoLog(object->name, sizeof(infoLog), nullptr, infoLog);
+				OpenGL::checkError();
+
+				Logs::error("simplicity::opengl", "Error compiling shader:");
+				Logs::error("simplicity::opengl", infoLog);
+			}
+
+			object->checked = true;
+			object->valid = compileStatus != 0;
+
+			return object->valid;
+		}
+
+		void OpenGLShader::compile()
+		{
+			if (object->compiled)
+			{
+				return;
+			}
+
 			if (type == Type::FRAGMENT)
 			{
-				shader = glCreateShader(GL_FRAGMENT_SHADER);
+				object->name = glCreateShader(GL_FRAGMENT_SHADER);
 				OpenGL::checkError();
 			}
 			else if (type == Type::GEOMETRY)
 			{
-				shader = glCreateShader(GL_GEOMETRY_SHADER);
+				object->name = glCreateShader(GL_GEOMETRY_SHADER);
 				OpenGL::checkError();
 			}
 			else if (type == Type::VERTEX)
 			{
-				shader = glCreateShader(GL_VERTEX_SHADER);
+				object->name = glCreateShader(GL_VERTEX_SHADER);
 				OpenGL::checkError();
 			}
 
 			const char* sourcePtr = source.data();
 			const int sourceLength = -1;
-			glShaderSource(shader, 1, &sourcePtr, &sourceLength);
+			glShaderSource(object->name, 1, &sourcePtr, &sourceLength);
 			OpenGL::checkError();
 
-			glCompileShader(shader);
+			// Querying the status here would force the driver to finish compiling before we can submit anything else.
+			glCompileShader(object->name);
 			OpenGL::checkError();
 
-			GLint compileStatus;
-			glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
-			OpenGL::checkError();
+			object->compiled = true;
+		}
 
-			if (compileStatus == 0)
+		GLuint OpenGLShader::getShader()
+		{
+			return object->name;
+		}
+
+		const string& OpenGLShader::getResourceName() const
+		{
+			return resourceName;
+		}
+
+		const string& OpenGLShader::getSource() const
+		{
+			return source;
+		}
+
+		Shader::Type OpenGLShader::getType() const
+		{
+			return type;
+		}
+
+		set<string> OpenGLShader::getUniformNames(const string& source)
+		{
+			auto isIdentifier = [](char character)
 			{
-				GLchar infoLog[1024];
-				glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
-				OpenGL::checkError();
+				return isalnum(static_cast<unsigned char>(character)) || character == '_';
+			};
 
-				Logs::error("simplicity::opengl", "Error compiling shader:");
-				Logs::error("simplicity::opengl", infoLog);
+			string code = removeComments(source);
+			set<string> names;
+			for (size_t uniform = code.find("uniform"); uniform != string::npos;
+					uniform = code.find("uniform", uniform + 1))
+			{
+				size_t start = uniform + 7;
+				if ((uniform > 0 && isIdentifier(code[uniform - 1])) || start >= code.size() ||
+						!isspace(static_cast<unsigned char>(code[start])))
+				{
+					continue;
+				}
+
+				// The name is the last identifier before any array size or initializer, e.g.
+				// 'uniform highp vec4 colors[4];'.
+				size_t end = min(code.find_first_of(";[={", start), code.size());
+				string name;
+				for (size_t index = start; index < end; index++)
+				{
+					if (isIdentifier(code[index]))
+					{
+						if (!isIdentifier(code[index - 1]))
+						{
+							name.clear();
+						}
+						name += code[index];
+					}
+				}
+
+				if (!name.empty())
+				{
+					names.insert(name);
+				}
+			}
+
+			return names;
+		}
+
+		void OpenGLShader::init()
+		{
+			compile();
+			checkCompileStatus();
+		}
+
+		bool OpenGLShader::isCompiled() const
+		{
+			return object->compiled;
+		}
+
+		string OpenGLShader::removeComments(const string& source)
+		{
+			string code = source;
+			for (size_t index = 0; index + 1 < code.size(); index++)
+			{
+				size_t end = index;
+				if (code.compare(index, 2, "//") == 0)
+				{
+					end = min(code.find('\n', index), code.size());
+				}
+				else if (code.compare(index, 2, "/*") == 0)
+				{
+					end = code.find("*/", index + 2);
+					end = end == string::npos ? code.size() : end + 2;
+				}
+
+				if (end > index)
+				{
+					for (size_t blank = index; blank < end; blank++)
+					{
+						if (code[blank] != '\n')
+						{
+							code[blank] = ' ';
+						}
+					}
+					index = end - 1;
+				}
+			}
+
+			return code;
+		}
+
+		OpenGLShader::Object::Object() :
+			checked(false),
+			compiled(false),
+			name(0),
+			valid(false)
+		{
+		}
+
+		OpenGLShader::Object::~Object()
+		{
+			// The driver keeps the shader alive until it is detached from any programs still using it.
+			if (name != 0)
+			{
+				glDeleteShader(name);
+				OpenGL::checkError();
 			}
 		}
 	}
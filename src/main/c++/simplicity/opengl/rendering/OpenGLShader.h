@@ -17,7 +17,10 @@
 #ifndef OPENGLSHADER_H_
 #define OPENGLSHADER_H_
 
+#include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <GL/glew.h>
 
@@ -28,6 +31,12 @@ namespace simplicity
 {
 	namespace opengl
 	{
+		/**
+		 * <p>
+		 * A shader implemented using OpenGL. Copies share the same OpenGL shader object, so the source is only ever
+		 * compiled once no matter how many pipelines the copies are attached to.
+		 * </p>
+		 */
 		class SIMPLE_API OpenGLShader : public Shader
 		{
 			public:
@@ -35,14 +44,120 @@ namespace simplicity
 
 				OpenGLShader(Type type, const std::string& source);
 
+				/**
+				 * @param type The type of shader.
+				 * @param source The source, which may differ from the resource's data (e.g. when reloading).
+				 * @param resourceName The name of the resource the source was loaded from.
+				 */
+				OpenGLShader(Type type, const std::string& source, const std::string& resourceName);
+
+				OpenGLShader(const OpenGLShader& original) = default;
+
 				~OpenGLShader();
 
+				/**
+				 * <p>
+				 * Adds #defines to shader source, after the #version directive if there is one.
+				 * </p>
+				 *
+				 * @param source The shader source.
+				 * @param defines The names to define.
+				 *
+				 * @return The shader source with the #defines added.
+				 */
+				static std::string addDefines(const std::string& source, const std::vector<std::string>& defines);
+
+				/**
+				 * <p>
+				 * Checks whether the shader compiled successfully and logs the errors if not. This will block until the
+				 * driver has finished compiling.
+				 * </p>
+				 *
+				 * @return True if the shader compiled successfully, false otherwise.
+				 */
+				bool checkCompileStatus();
+
+				/**
+				 * <p>
+				 * Submits the shader for compilation without waiting for the result, so several shaders can be
+				 * compiled in parallel by drivers that support it.
+				 * </p>
+				 */
+				void compile();
+
+				/**
+				 * @return The name of the resource the source was loaded from, empty if it was not loaded from a
+				 * resource.
+				 */
+				const std::string& getResourceName() const;
+
 				GLuint getShader();
 
+				const std::string& getSource() const;
+
+				Type getType() const;
+
+				/**
+				 * <p>
+				 * Finds the names of the uniforms declared in shader source, whether the compiler keeps them active or
+				 * not. Only the names declared outside of uniform blocks are of use, members of blocks may be
+				 * included too.
+				 * </p>
+				 *
+				 * @param source The shader source.
+				 *
+				 * @return The names of the uniforms.
+				 */
+				static std::set<std::string> getUniformNames(const std::string& source);
+
+				/**
+				 * <p>
+				 * Compiles the shader and checks the result.
+				 * </p>
+				 */
 				void init();
 
+				/**
+				 * @return True if the shader has been submitted for compilation, false otherwise.
+				 */
+				bool isCompiled() const;
+
+				/**
+				 * <p>
+				 * Replaces the comments in shader source with spaces, keeping the line breaks so preprocessor
+				 * directives stay on lines of their own.
+				 * </p>
+				 *
+				 * @param source The shader source.
+				 *
+				 * @return The shader source without comments.
+				 */
+				static std::string removeComments(const std::string& source);
+
 			private:
-				GLuint shader;
+				/**
+				 * <p>
+				 * The OpenGL shader object, shared between copies.
+				 * </p>
+				 */
+				struct Object
+				{
+					Object();
+
+					~Object();
+
+					bool checked;
+
+					bool compiled;
+
+					GLuint name;
+
+					bool valid;
+				};
+
+				std::shared_ptr<Object> object;
+
+				std::string resourceName;
 
 				std::string source;
 
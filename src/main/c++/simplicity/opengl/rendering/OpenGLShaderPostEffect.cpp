@@ -0,0 +1,49 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <simplicity/rendering/RenderingFactory.h>
+
+#include "OpenGLShaderPostEffect.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		OpenGLShaderPostEffect::OpenGLShaderPostEffect(unique_ptr<Shader> fragmentShader) :
+			pipeline(),
+			renderState(new OpenGLRenderState(OpenGLRenderState::getPostProcess().getDescription()))
+		{
+			// Created directly rather than through the factory so no other effect can end up sharing its parameters.
+			unique_ptr<Shader> vertexShader =
+					RenderingFactory::createShader(Shader::Type::VERTEX, "fullscreenTriangle");
+			pipeline.reset(new OpenGLPipeline(move(vertexShader), nullptr, move(fragmentShader)));
+			pipeline->setRenderState(renderState);
+		}
+
+		Pipeline& OpenGLShaderPostEffect::getPipeline()
+		{
+			return *pipeline;
+		}
+
+		void OpenGLShaderPostEffect::process(OpenGLRenderingEngine& engine, const shared_ptr<Texture>& source,
+				FrameBuffer* target)
+		{
+			bindTarget(engine, target);
+
+			pipeline->apply();
+			pipeline->set("sampler", 0);
+
+			draw(pipeline, source);
+		}
+	}
+}
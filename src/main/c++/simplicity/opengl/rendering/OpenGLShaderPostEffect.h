@@ -0,0 +1,57 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLSHADERPOSTEFFECT_H_
+#define OPENGLSHADERPOSTEFFECT_H_
+
+#include <simplicity/rendering/Shader.h>
+
+#include "OpenGLPipeline.h"
+#include "OpenGLPostEffect.h"
+#include "OpenGLRenderState.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * A post processing effect made of a single full screen pass of a fragment shader (e.g. tone mapping, FXAA or
+		 * a color grading lookup). The shader reads the source image through a sampler named "sampler" and the
+		 * texture coordinates of the fullscreenTriangle vertex shader. Any other parameters can be set on the pipeline,
+		 * which belongs to the effect alone.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLShaderPostEffect : public OpenGLPostEffect
+		{
+			public:
+				/**
+				 * @param fragmentShader The fragment shader.
+				 */
+				OpenGLShaderPostEffect(std::unique_ptr<Shader> fragmentShader);
+
+				/**
+				 * @return The pipeline the pass is drawn with.
+				 */
+				Pipeline& getPipeline();
+
+				void process(OpenGLRenderingEngine& engine, const std::shared_ptr<Texture>& source,
+						FrameBuffer* target) override;
+
+			private:
+				std::shared_ptr<OpenGLPipeline> pipeline;
+
+				std::shared_ptr<const OpenGLRenderState> renderState;
+		};
+	}
+}
+
+#endif /* OPENGLSHADERPOSTEFFECT_H_ */
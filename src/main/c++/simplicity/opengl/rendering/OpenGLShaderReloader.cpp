@@ -0,0 +1,262 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <simplicity/logging/Logs.h>
+#include <simplicity/resources/Resources.h>
+
+#include "../common/Hash.h"
+#include "OpenGLPipeline.h"
+#include "OpenGLShaderReloader.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace OpenGLShaderReloader
+		{
+			namespace
+			{
+				bool enabled = false;
+
+				unsigned int interval = 500;
+
+				chrono::steady_clock::time_point lastPoll;
+
+				set<OpenGLPipeline*> pipelines;
+
+				// The resources left to read in the current poll.
+				vector<string> pollQueue;
+
+				set<OpenGLPipeline*> reloadingPipelines;
+
+				// The hash of what each resource held when it was last read.
+				map<string, uint64_t> resourceHashes;
+
+				// The number of watched pipelines using each resource.
+				map<string, unsigned int> resourceUsers;
+
+				bool read(const string& resourceName, string& source)
+				{
+					// Looked up again for every read, the resource is not ours to hold on to.
+					Resource* resource = Resources::get(resourceName);
+					if (resource == nullptr)
+					{
+						return false;
+					}
+
+					source = resource->getData();
+					return true;
+				}
+
+				void hash(const vector<string>& resourceNames)
+				{
+					for (const string& resourceName : resourceNames)
+					{
+						string source;
+						if (read(resourceName, source))
+						{
+							resourceHashes[resourceName] = Hash::fnv1a(source);
+						}
+					}
+				}
+
+				void poll(map<string, string>& changedSources)
+				{
+					if (pollQueue.empty())
+					{
+						chrono::steady_clock::time_point now = chrono::steady_clock::now();
+						if (now - lastPoll < chrono::milliseconds(interval))
+						{
+							return;
+						}
+						lastPoll = now;
+
+						for (const pair<const string, unsigned int>& resourceUser : resourceUsers)
+						{
+							pollQueue.push_back(resourceUser.first);
+						}
+					}
+
+					if (pollQueue.empty())
+					{
+						return;
+					}
+
+					// One resource per frame, so no frame waits on more than a single read.
+					string resourceName = pollQueue.back();
+					pollQueue.pop_back();
+
+					// It may have been unwatched since the poll started.
+					string source;
+					if (resourceUsers.find(resourceName) == resourceUsers.end() || !read(resourceName, source))
+					{
+						return;
+					}
+
+					uint64_t sourceHash = Hash::fnv1a(source);
+					auto resourceHash = resourceHashes.find(resourceName);
+					if (resourceHash == resourceHashes.end())
+					{
+						// It could not be read when it was watched, there is nothing to compare it with.
+						resourceHashes[resourceName] = sourceHash;
+					}
+					else if (resourceHash->second != sourceHash)
+					{
+						resourceHash->second = sourceHash;
+						changedSources[resourceName] = source;
+					}
+				}
+			}
+
+			unsigned int getInterval()
+			{
+				return interval;
+			}
+
+			bool isEnabled()
+			{
+				return enabled;
+			}
+
+			void setEnabled(bool enabled)
+			{
+				if (enabled == OpenGLShaderReloader::enabled)
+				{
+					return;
+				}
+
+				OpenGLShaderReloader::enabled = enabled;
+				pollQueue.clear();
+
+				if (enabled)
+				{
+					// Start from what the resources hold now so the first poll does not count as a change.
+					vector<string> resourceNames;
+					for (const pair<const string, unsigned int>& resourceUser : resourceUsers)
+					{
+						resourceNames.push_back(resourceUser.first);
+					}
+					hash(resourceNames);
+
+					lastPoll = chrono::steady_clock::now();
+				}
+				else
+				{
+					// Changes made while disabled are not picked up, the resources are hashed again when re-enabled.
+					resourceHashes.clear();
+				}
+			}
+
+			void setInterval(unsigned int interval)
+			{
+				OpenGLShaderReloader::interval = interval;
+			}
+
+			void unwatch(OpenGLPipeline& pipeline)
+			{
+				if (pipelines.erase(&pipeline) == 0)
+				{
+					return;
+				}
+
+				reloadingPipelines.erase(&pipeline);
+
+				for (const string& resourceName : pipeline.getResourceNames())
+				{
+					auto resourceUser = resourceUsers.find(resourceName);
+					if (resourceUser == resourceUsers.end() || --resourceUser->second > 0)
+					{
+						continue;
+					}
+
+					resourceUsers.erase(resourceUser);
+					resourceHashes.erase(resourceName);
+				}
+			}
+
+			void update()
+			{
+				// Reloads started on earlier frames have had time to compile, check on them before starting new ones.
+				for (auto pipeline = reloadingPipelines.begin(); pipeline != reloadingPipelines.end();)
+				{
+					if ((*pipeline)->finishReload())
+					{
+						pipeline = reloadingPipelines.erase(pipeline);
+					}
+					else
+					{
+						pipeline++;
+					}
+				}
+
+				if (!enabled)
+				{
+					return;
+				}
+
+				map<string, string> sources;
+				poll(sources);
+
+				if (sources.empty())
+				{
+					return;
+				}
+
+				for (pair<const string, string>& source : sources)
+				{
+					Logs::info("simplicity::opengl", "Reloading shader %s", source.first.data());
+				}
+
+				for (OpenGLPipeline* pipeline : pipelines)
+				{
+					if (pipeline->beginReload(sources))
+					{
+						reloadingPipelines.insert(pipeline);
+					}
+				}
+			}
+
+			void watch(OpenGLPipeline& pipeline)
+			{
+				if (!pipelines.insert(&pipeline).second)
+				{
+					return;
+				}
+
+				vector<string> newResourceNames;
+				for (const string& resourceName : pipeline.getResourceNames())
+				{
+					if (resourceUsers[resourceName]++ == 0)
+					{
+						newResourceNames.push_back(resourceName);
+					}
+				}
+
+				// The resources are only read while enabled, setEnabled() catches up with the ones watched before.
+				if (!enabled)
+				{
+					return;
+				}
+
+				// Start from what the resources hold now so the first poll does not count as a change.
+				hash(newResourceNames);
+			}
+		}
+	}
+}
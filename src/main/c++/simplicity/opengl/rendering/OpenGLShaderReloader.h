@@ -0,0 +1,94 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLSHADERRELOADER_H_
+#define OPENGLSHADERRELOADER_H_
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		class OpenGLPipeline;
+
+		/**
+		 * <p>
+		 * Reloads pipelines when the resources their shaders were loaded from change, so shaders can be worked on
+		 * without restarting.
+		 * </p>
+		 *
+		 * <p>
+		 * While enabled, the resources are polled for changes from update(), one resource per frame so that no frame
+		 * waits on more than a single read. Resources are looked up by name each time they are read (see
+		 * Resources::get()), the reloader never holds on to them. Changed source is compiled and linked into a new
+		 * program without waiting for the result (in parallel where GL_KHR_parallel_shader_compile is available) and
+		 * the new program is only swapped into the pipeline on a later frame, once it has linked successfully. Until
+		 * then, or if it fails, the pipeline keeps using its current program.
+		 * </p>
+		 */
+		namespace OpenGLShaderReloader
+		{
+			/**
+			 * @return The number of milliseconds between polls of the resources.
+			 */
+			SIMPLE_API unsigned int getInterval();
+
+			/**
+			 * @return True if resources are being watched for changes, false otherwise.
+			 */
+			SIMPLE_API bool isEnabled();
+
+			/**
+			 * <p>
+			 * Starts or stops watching resources for changes. Disabled by default.
+			 * </p>
+			 *
+			 * @param enabled True to watch resources for changes, false to stop.
+			 */
+			SIMPLE_API void setEnabled(bool enabled);
+
+			/**
+			 * @param interval The number of milliseconds between polls of the resources.
+			 */
+			SIMPLE_API void setInterval(unsigned int interval);
+
+			/**
+			 * <p>
+			 * Starts reloading the pipelines affected by changes found since the last update and swaps in the
+			 * programs of earlier reloads that have finished linking. Should be called once per frame.
+			 * </p>
+			 */
+			SIMPLE_API void update();
+
+			/**
+			 * <p>
+			 * Stops watching a pipeline's resources.
+			 * </p>
+			 *
+			 * @param pipeline The pipeline.
+			 */
+			SIMPLE_API void unwatch(OpenGLPipeline& pipeline);
+
+			/**
+			 * <p>
+			 * Watches a pipeline's resources, reloading the pipeline when they change. The resources are only read
+			 * while the reloader is enabled, so watching costs next to nothing otherwise.
+			 * </p>
+			 *
+			 * @param pipeline The pipeline.
+			 */
+			SIMPLE_API void watch(OpenGLPipeline& pipeline);
+		}
+	}
+}
+
+#endif /* OPENGLSHADERRELOADER_H_ */
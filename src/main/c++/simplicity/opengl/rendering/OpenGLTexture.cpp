@@ -16,10 +16,18 @@
  */
 #include <string.h>
 
+#include <algorithm>
+
 #include <FreeImagePlus.h>
 
+#include <simplicity/logging/Logs.h>
+
 #include "../common/OpenGL.h"
 #include "OpenGLTexture.h"
+#include "OpenGLTextureCache.h"
+#include "OpenGLTextureManager.h"
+#include "OpenGLTextureReadback.h"
+#include "TextureContainer.h"
 
 using namespace std;
 
@@ -27,40 +35,120 @@ namespace simplicity
 {
 	namespace opengl
 	{
+		namespace
+		{
+			bool isValid(const OpenGLTextureCache::Entry& entry, GLenum format, GLenum internalFormat)
+			{
+				const OpenGLTextureCache::Description& description = entry.description;
+				if (entry.levels.empty() || description.compressed || description.alignment == 0 ||
+					description.format != format || description.internalFormat != internalFormat)
+				{
+					return false;
+				}
+
+				size_t componentCount = 0;
+				if (format == GL_BGR || format == GL_RGB)
+				{
+					componentCount = 3;
+				}
+				else if (format == GL_BGRA || format == GL_RGBA)
+				{
+					componentCount = 4;
+				}
+
+				size_t componentSize = 0;
+				if (description.type == GL_UNSIGNED_BYTE)
+				{
+					componentSize = 1;
+				}
+				else if (description.type == GL_FLOAT)
+				{
+					componentSize = sizeof(float);
+				}
+
+				if (componentCount == 0 || componentSize == 0)
+				{
+					return false;
+				}
+
+				unsigned int width = entry.levels[0].width;
+				unsigned int height = entry.levels[0].height;
+				for (unsigned int index = 0; index < entry.levels.size(); index++)
+				{
+					const OpenGLTextureCache::Level& level = entry.levels[index];
+					if (level.data == nullptr || level.width != max(width >> index, 1u) ||
+						level.height != max(height >> index, 1u))
+					{
+						return false;
+					}
+
+					size_t rowSize = level.width * componentCount * componentSize;
+					rowSize = (rowSize + description.alignment - 1) / description.alignment * description.alignment;
+					if (level.size != rowSize * level.height)
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+		}
+
 		OpenGLTexture::OpenGLTexture(const char* data, unsigned int length, PixelFormat format) :
+			containerSize(0),
 			data(data, length),
+			depthFormat(0),
+			dirty(true),
+			evictable(true),
 			format(format),
 			height(0),
 			initialized(false),
+			levelCount(1),
 			rawData(nullptr),
+			residency(Residency::CPU_AND_GPU),
+			target(GL_TEXTURE_2D),
 			texture(0),
 			width(0)
 		{
 		}
 
 		OpenGLTexture::OpenGLTexture(const char* rawData, unsigned int width, unsigned int height, PixelFormat format) :
+			containerSize(0),
 			data(),
+			depthFormat(0),
 			dirty(false),
+			evictable(rawData != nullptr),
 			format(format),
 			height(height),
 			initialized(false),
-			rawData(new char[width * height * getPixelDepth(format)]),
+			levelCount(1),
+			rawData(nullptr),
+			residency(Residency::CPU_AND_GPU),
+			target(GL_TEXTURE_2D),
 			texture(0),
 			width(width)
 		{
+			// Textures without initial data (e.g. frame buffer attachments) only get a CPU copy if it is asked for.
 			if (rawData != nullptr)
 			{
-				memcpy(this->rawData, rawData, width * height * getPixelDepth(format));
+				this->rawData = new char[width * height * getOpenGLPixelSize()];
+				memcpy(this->rawData, rawData, width * height * getOpenGLPixelSize());
 			}
 		}
 
 		OpenGLTexture::OpenGLTexture(Resource& image, PixelFormat format) :
+			containerSize(0),
 			data(image.getData()),
+			depthFormat(0),
 			dirty(true),
+			evictable(true),
 			format(format),
 			height(0),
 			initialized(false),
-			rawData(new char[width * height * getPixelDepth(format)]),
+			levelCount(1),
+			rawData(nullptr),
+			residency(Residency::CPU_AND_GPU),
+			target(GL_TEXTURE_2D),
 			texture(0),
 			width(0)
 		{
@@ -68,6 +156,14 @@ namespace simplicity
 
 		OpenGLTexture::~OpenGLTexture()
 		{
+			OpenGLTextureManager::onReleased(*this);
+
+			if (texture != 0)
+			{
+				glDeleteTextures(1, &texture);
+				OpenGL::checkError();
+			}
+
 			delete[] rawData;
 		}
 
@@ -80,10 +176,53 @@ namespace simplicity
 				init();
 			}
 
+			// A copy read back on demand is only valid until the texture is used (and possibly rendered to) again.
+			if (residency == Residency::CPU_ON_DEMAND && rawData != nullptr)
+			{
+				delete[] rawData;
+				rawData = nullptr;
+			}
+
 			glActiveTexture(GL_TEXTURE0);
 			OpenGL::checkError();
-			glBindTexture(GL_TEXTURE_2D, texture);
+			glBindTexture(target, texture);
 			OpenGL::checkError();
+
+			OpenGLTextureManager::onApplied(*this);
+		}
+
+		shared_ptr<OpenGLTexture> OpenGLTexture::createDepthTexture(unsigned int width, unsigned int height,
+				GLenum internalFormat)
+		{
+			shared_ptr<OpenGLTexture> texture(new OpenGLTexture(nullptr, width, height, PixelFormat::RGBA));
+			texture->depthFormat = internalFormat;
+
+			return texture;
+		}
+
+		void OpenGLTexture::evict()
+		{
+			if (!evictable || !initialized)
+			{
+				return;
+			}
+
+			glDeleteTextures(1, &texture);
+			OpenGL::checkError();
+
+			texture = 0;
+			initialized = false;
+		}
+
+		size_t OpenGLTexture::getCPUMemorySize() const
+		{
+			size_t size = data.size();
+			if (rawData != nullptr)
+			{
+				size += width * height * getOpenGLPixelSize();
+			}
+
+			return size;
 		}
 
 		unsigned int OpenGLTexture::getHeight() const
@@ -93,6 +232,11 @@ namespace simplicity
 
 		GLenum OpenGLTexture::getOpenGLInternalPixelFormat() const
 		{
+			if (depthFormat != 0)
+			{
+				return depthFormat;
+			}
+
 			if (format == PixelFormat::BGR || format == PixelFormat::RGB)
 			{
 				return GL_RGB;
@@ -116,8 +260,60 @@ namespace simplicity
 			return -1;
 		}
 
+		unsigned int OpenGLTexture::getOpenGLInternalPixelSize() const
+		{
+			if (depthFormat != 0)
+			{
+				return 4;
+			}
+
+			// Drivers generally pad three component formats out to four components.
+			if (format == PixelFormat::BGR || format == PixelFormat::RGB ||
+				format == PixelFormat::BGRA || format == PixelFormat::RGBA)
+			{
+				return 4;
+			}
+
+			if (format == PixelFormat::BGR_HDR || format == PixelFormat::RGB_HDR ||
+				format == PixelFormat::BGRA_HDR || format == PixelFormat::RGBA_HDR)
+			{
+				return 8;
+			}
+
+			return 0;
+		}
+
+		size_t OpenGLTexture::getMemorySize() const
+		{
+			// Textures loaded from containers are uploaded exactly as stored (possibly compressed).
+			if (containerSize != 0)
+			{
+				return containerSize;
+			}
+
+			size_t size = 0;
+			for (unsigned int level = 0; level < levelCount; level++)
+			{
+				size_t levelWidth = max(width >> level, 1u);
+				size_t levelHeight = max(height >> level, 1u);
+				size += levelWidth * levelHeight * getOpenGLInternalPixelSize();
+			}
+
+			return size;
+		}
+
 		GLenum OpenGLTexture::getOpenGLPixelFormat() const
 		{
+			if (depthFormat == GL_DEPTH24_STENCIL8)
+			{
+				return GL_DEPTH_STENCIL;
+			}
+
+			if (depthFormat != 0)
+			{
+				return GL_DEPTH_COMPONENT;
+			}
+
 			if (format == PixelFormat::BGR || format == PixelFormat::BGR_HDR)
 			{
 				return GL_BGR;
@@ -141,6 +337,53 @@ namespace simplicity
 			return -1;
 		}
 
+		unsigned int OpenGLTexture::getOpenGLPixelSize() const
+		{
+			if (depthFormat != 0)
+			{
+				return 4;
+			}
+
+			// HDR pixels are transferred as floats.
+			if (format == PixelFormat::BGR_HDR || format == PixelFormat::RGB_HDR)
+			{
+				return 3 * sizeof(float);
+			}
+
+			if (format == PixelFormat::BGRA_HDR || format == PixelFormat::RGBA_HDR)
+			{
+				return 4 * sizeof(float);
+			}
+
+			return getPixelDepth(format);
+		}
+
+		GLenum OpenGLTexture::getOpenGLPixelType() const
+		{
+			if (depthFormat == GL_DEPTH24_STENCIL8)
+			{
+				return GL_UNSIGNED_INT_24_8;
+			}
+
+			if (depthFormat == GL_DEPTH_COMPONENT32F)
+			{
+				return GL_FLOAT;
+			}
+
+			if (depthFormat != 0)
+			{
+				return GL_UNSIGNED_INT;
+			}
+
+			if (format == PixelFormat::BGR_HDR || format == PixelFormat::BGRA_HDR ||
+				format == PixelFormat::RGB_HDR || format == PixelFormat::RGBA_HDR)
+			{
+				return GL_FLOAT;
+			}
+
+			return GL_UNSIGNED_BYTE;
+		}
+
 		PixelFormat OpenGLTexture::getPixelFormat() const
 		{
 			return format;
@@ -148,12 +391,58 @@ namespace simplicity
 
 		const char* OpenGLTexture::getRawData() const
 		{
-			if (dirty)
+			if (residency == Residency::GPU_ONLY)
+			{
+				Logs::error("simplicity::opengl", "Cannot get the raw data of a GPU only texture");
+				return nullptr;
+			}
+
+			if (target != GL_TEXTURE_2D)
+			{
+				Logs::error("simplicity::opengl", "Can only get the raw data of 2D textures");
+				return nullptr;
+			}
+
+			if (!initialized)
+			{
+				// There is nothing on the GPU to read yet, the CPU side copy (if any) is all there is.
+				return rawData;
+			}
+
+			if (residency == Residency::CPU_ON_DEMAND)
 			{
+				// Read through a pack buffer like getRawDataAsync() does, the copy is freed when next applied.
+				future<vector<char>> pixels = getRawDataAsync();
+				OpenGLTextureReadback::update(true);
+				vector<char> pixelData = pixels.get();
+
+				delete[] rawData;
+				rawData = new char[pixelData.size()];
+				memcpy(rawData, pixelData.data(), pixelData.size());
+
+				return rawData;
+			}
+
+			if (dirty || rawData == nullptr)
+			{
+				if (rawData == nullptr)
+				{
+					rawData = new char[width * height * getOpenGLPixelSize()];
+				}
+
 				glBindTexture(GL_TEXTURE_2D, texture);
 				OpenGL::checkError();
 
-				glGetTexImage(GL_TEXTURE_2D, 0, getOpenGLInternalPixelFormat(), GL_UNSIGNED_BYTE, rawData);
+				GLint packAlignment = 4;
+				glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+				OpenGL::checkError();
+				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+				OpenGL::checkError();
+
+				glGetTexImage(GL_TEXTURE_2D, 0, getOpenGLPixelFormat(), getOpenGLPixelType(), rawData);
+				OpenGL::checkError();
+
+				glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
 				OpenGL::checkError();
 
 				dirty = false;
@@ -162,6 +451,34 @@ namespace simplicity
 			return rawData;
 		}
 
+		future<vector<char>> OpenGLTexture::getRawDataAsync() const
+		{
+			if (target != GL_TEXTURE_2D)
+			{
+				Logs::error("simplicity::opengl", "Can only get the raw data of 2D textures");
+				return future<vector<char>>();
+			}
+
+			if (!initialized)
+			{
+				Logs::error("simplicity::opengl", "Cannot read back a texture that has not been initialized");
+				return future<vector<char>>();
+			}
+
+			return OpenGLTextureReadback::issue(texture, getOpenGLPixelFormat(), getOpenGLPixelType(),
+					width * height * getOpenGLPixelSize());
+		}
+
+		OpenGLTexture::Residency OpenGLTexture::getResidency() const
+		{
+			return residency;
+		}
+
+		GLenum OpenGLTexture::getTarget() const
+		{
+			return target;
+		}
+
 		GLuint OpenGLTexture::getTexture() const
 		{
 			return texture;
@@ -177,47 +494,348 @@ namespace simplicity
 			glGenTextures(1, &texture);
 			OpenGL::checkError();
 
-			if (!data.empty())
+			bool ktx = TextureContainer::isKTX(data.data(), data.size());
+			if (ktx || TextureContainer::isDDS(data.data(), data.size()))
+			{
+				// GPU ready containers are uploaded straight from the source, levels and all.
+				TextureContainer::Contents contents;
+				bool read = ktx ? TextureContainer::readKTX(data.data(), data.size(), contents) :
+						TextureContainer::readDDS(data.data(), data.size(), contents);
+				if (!read)
+				{
+					// Leave the texture uninitialized rather than pretending an empty texture was uploaded.
+					glDeleteTextures(1, &texture);
+					OpenGL::checkError();
+					texture = 0;
+					return;
+				}
+
+				upload(contents);
+			}
+			else if (!data.empty())
 			{
 				glBindTexture(GL_TEXTURE_2D, texture);
 				OpenGL::checkError();
 
-				fipImage image;
-
-				fipMemoryIO memory(reinterpret_cast<BYTE*>(&data[0]), data.size());
-				image.loadFromMemory(memory);
-
-				height = image.getHeight();
-				width = image.getWidth();
-
-				glTexImage2D(GL_TEXTURE_2D, 0, getOpenGLInternalPixelFormat(), width, height, 0,
-						getOpenGLPixelFormat(), GL_UNSIGNED_BYTE, image.accessPixels());
-				OpenGL::checkError();
-
-				data.resize(0);
+				// Decoding dominates the cost of initializing a texture so look for an already decoded copy first.
+				uint64_t cacheKey = 0;
+				unique_ptr<OpenGLTextureCache::Entry> cached;
+				if (OpenGLTextureCache::isEnabled())
+				{
+					cacheKey = OpenGLTextureCache::hash(data.data(), data.size(), static_cast<uint64_t>(format));
+					cached = OpenGLTextureCache::find(cacheKey);
+				}
+
+				if (cached != nullptr && !isValid(*cached, getOpenGLPixelFormat(), getOpenGLInternalPixelFormat()))
+				{
+					Logs::warning("simplicity::opengl", "Ignoring texture cache entry that does not match the texture");
+					cached.reset();
+				}
+
+				if (cached != nullptr)
+				{
+					TextureContainer::Contents contents;
+					contents.alignment = cached->description.alignment;
+					contents.compressed = cached->description.compressed;
+					contents.format = cached->description.format;
+					contents.height = cached->levels[0].height;
+					contents.internalFormat = cached->description.internalFormat;
+					contents.levelCount = static_cast<unsigned int>(cached->levels.size());
+					contents.type = cached->description.type;
+					contents.width = cached->levels[0].width;
+
+					for (unsigned int level = 0; level < cached->levels.size(); level++)
+					{
+						TextureContainer::Image image;
+						image.data = cached->levels[level].data;
+						image.depth = 1;
+						image.face = 0;
+						image.height = cached->levels[level].height;
+						image.layer = 0;
+						image.level = level;
+						image.size = cached->levels[level].size;
+						image.width = cached->levels[level].width;
+						contents.images.push_back(image);
+					}
+
+					upload(contents);
+				}
+				else
+				{
+					containerSize = 0;
+					levelCount = 1;
+					target = GL_TEXTURE_2D;
+
+					fipImage image;
+
+					fipMemoryIO memory(reinterpret_cast<BYTE*>(&data[0]), data.size());
+					image.loadFromMemory(memory);
+
+					height = image.getHeight();
+					width = image.getWidth();
+
+					glTexImage2D(GL_TEXTURE_2D, 0, getOpenGLInternalPixelFormat(), width, height, 0,
+							getOpenGLPixelFormat(), GL_UNSIGNED_BYTE, image.accessPixels());
+					OpenGL::checkError();
+
+					if (OpenGLTextureCache::isEnabled())
+					{
+						// FreeImage aligns scan lines to 4 bytes, which is also OpenGL's default unpack alignment.
+						OpenGLTextureCache::Description description;
+						description.alignment = 4;
+						description.compressed = false;
+						description.format = getOpenGLPixelFormat();
+						description.internalFormat = getOpenGLInternalPixelFormat();
+						description.type = GL_UNSIGNED_BYTE;
+
+						OpenGLTextureCache::Level level;
+						level.data = reinterpret_cast<const char*>(image.accessPixels());
+						level.height = height;
+						level.size = image.getScanWidth() * height;
+						level.width = width;
+
+						OpenGLTextureCache::store(cacheKey, description, { level });
+					}
+				}
 			}
 			else
 			{
 				setRawData(rawData);
 			}
 
-			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			GLint minFilter = levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+			glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter);
 			OpenGL::checkError();
-			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameterf(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 			OpenGL::checkError();
 
 			initialized = true;
+
+			if (residency != Residency::CPU_AND_GPU)
+			{
+				releaseSource();
+			}
+			else if (!data.empty() && OpenGLTextureManager::getBudget() == 0)
+			{
+				// Without a budget nothing is evicted, so the encoded source would never be uploaded from again.
+				size_t releasedSize = data.size();
+				string().swap(data);
+				evictable = false;
+
+				OpenGLTextureManager::onSourceReleased(releasedSize);
+			}
+
+			OpenGLTextureManager::onUploaded(*this);
+		}
+
+		bool OpenGLTexture::isEvictable() const
+		{
+			return evictable;
+		}
+
+		bool OpenGLTexture::isDepth() const
+		{
+			return depthFormat != 0;
+		}
+
+		bool OpenGLTexture::isInitialized() const
+		{
+			return initialized;
+		}
+
+		void OpenGLTexture::releaseSource()
+		{
+			size_t releasedSize = getCPUMemorySize();
+
+			string().swap(data);
+			delete[] rawData;
+			rawData = nullptr;
+
+			// There is nothing left to upload from.
+			evictable = false;
+
+			OpenGLTextureManager::onSourceReleased(releasedSize);
+		}
+
+		void OpenGLTexture::resize(unsigned int width, unsigned int height)
+		{
+			if (width == this->width && height == this->height)
+			{
+				return;
+			}
+
+			if (!data.empty())
+			{
+				Logs::error("simplicity::opengl", "Only textures created from raw data can be resized");
+				return;
+			}
+
+			this->height = height;
+			this->width = width;
+
+			delete[] rawData;
+			rawData = nullptr;
+
+			if (initialized)
+			{
+				setRawData(nullptr);
+				OpenGLTextureManager::onUploaded(*this);
+			}
 		}
 
 		void OpenGLTexture::setRawData(const char* rawData)
 		{
-			memcpy(this->rawData, rawData, width * height * getPixelDepth(format));
+			if (residency == Residency::CPU_AND_GPU && rawData != nullptr && rawData != this->rawData)
+			{
+				if (this->rawData == nullptr)
+				{
+					this->rawData = new char[width * height * getOpenGLPixelSize()];
+				}
+
+				memcpy(this->rawData, rawData, width * height * getOpenGLPixelSize());
+			}
 
 			glBindTexture(GL_TEXTURE_2D, texture);
 			OpenGL::checkError();
 
 			glTexImage2D(GL_TEXTURE_2D, 0, getOpenGLInternalPixelFormat(), width, height, 0, getOpenGLPixelFormat(),
-					GL_UNSIGNED_BYTE, rawData);
+					getOpenGLPixelType(), rawData);
+			OpenGL::checkError();
+
+			// Any copy kept by other residencies (e.g. read back on demand) no longer matches the GPU.
+			if (residency != Residency::CPU_AND_GPU && rawData != this->rawData)
+			{
+				delete[] this->rawData;
+				this->rawData = nullptr;
+				dirty = true;
+			}
+		}
+
+		void OpenGLTexture::setResidency(Residency residency)
+		{
+			this->residency = residency;
+		}
+
+		void OpenGLTexture::upload(const TextureContainer::Contents& contents)
+		{
+			containerSize = 0;
+			height = contents.height;
+			levelCount = contents.levelCount;
+			target = contents.target;
+			width = contents.width;
+
+			glBindTexture(target, texture);
+			OpenGL::checkError();
+			GLint unpackAlignment = 4;
+			glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+			OpenGL::checkError();
+			glPixelStorei(GL_UNPACK_ALIGNMENT, contents.alignment);
+			OpenGL::checkError();
+
+			bool layered = target == GL_TEXTURE_2D_ARRAY || target == GL_TEXTURE_3D ||
+					target == GL_TEXTURE_CUBE_MAP_ARRAY;
+
+			if (layered)
+			{
+				// Allocate every level up front since the images might only cover some of the layers each.
+				for (unsigned int level = 0; level < levelCount; level++)
+				{
+					unsigned int levelDepth = contents.depth;
+					if (target == GL_TEXTURE_3D)
+					{
+						levelDepth = max(contents.depth >> level, 1u);
+					}
+
+					unsigned int levelHeight = max(contents.height >> level, 1u);
+					unsigned int levelWidth = max(contents.width >> level, 1u);
+
+					if (contents.compressed)
+					{
+						size_t levelSize = 0;
+						for (const TextureContainer::Image& image : contents.images)
+						{
+							if (image.level == level)
+							{
+								levelSize += image.size;
+							}
+						}
+
+						glCompressedTexImage3D(target, level, contents.internalFormat, levelWidth, levelHeight,
+								levelDepth, 0, static_cast<GLsizei>(levelSize), nullptr);
+						OpenGL::checkError();
+					}
+					else
+					{
+						glTexImage3D(target, level, contents.internalFormat, levelWidth, levelHeight, levelDepth, 0,
+								contents.format, contents.type, nullptr);
+						OpenGL::checkError();
+					}
+				}
+			}
+
+			for (const TextureContainer::Image& image : contents.images)
+			{
+				if (layered && contents.compressed)
+				{
+					glCompressedTexSubImage3D(target, image.level, 0, 0, image.layer, image.width, image.height,
+							image.depth, contents.internalFormat, static_cast<GLsizei>(image.size), image.data);
+					OpenGL::checkError();
+				}
+				else if (layered)
+				{
+					glTexSubImage3D(target, image.level, 0, 0, image.layer, image.width, image.height, image.depth,
+							contents.format, contents.type, image.data);
+					OpenGL::checkError();
+				}
+				else
+				{
+					GLenum imageTarget = target;
+					if (target == GL_TEXTURE_CUBE_MAP)
+					{
+						imageTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + image.face;
+					}
+
+					if (contents.compressed)
+					{
+						glCompressedTexImage2D(imageTarget, image.level, contents.internalFormat, image.width,
+								image.height, 0, static_cast<GLsizei>(image.size), image.data);
+						OpenGL::checkError();
+					}
+					else
+					{
+						glTexImage2D(imageTarget, image.level, contents.internalFormat, image.width, image.height, 0,
+								contents.format, contents.type, image.data);
+						OpenGL::checkError();
+					}
+				}
+
+				containerSize += image.size;
+			}
+
+			glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+			OpenGL::checkError();
+
+			// Compressed formats cannot be rendered to so OpenGL cannot generate their levels.
+			if (contents.generateMipmaps && contents.compressed)
+			{
+				Logs::warning("simplicity::opengl", "Cannot generate mipmaps for compressed textures");
+			}
+			else if (contents.generateMipmaps)
+			{
+				glGenerateMipmap(target);
+				OpenGL::checkError();
+
+				levelCount = 1;
+				while ((max(width, height) >> levelCount) > 0)
+				{
+					levelCount++;
+				}
+
+				// The generated levels add roughly another third.
+				containerSize += containerSize / 3;
+			}
+
+			glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
 			OpenGL::checkError();
 		}
 	}
@@ -17,7 +17,10 @@
 #ifndef OPENGLTEXTURE_H_
 #define OPENGLTEXTURE_H_
 
+#include <cstddef>
+#include <future>
 #include <string>
+#include <vector>
 
 #include <GL/glew.h>
 
@@ -25,6 +28,8 @@
 #include <simplicity/rendering/Texture.h>
 #include <simplicity/resources/Resource.h>
 
+#include "TextureContainer.h"
+
 namespace simplicity
 {
 	namespace opengl
@@ -37,6 +42,39 @@ namespace simplicity
 		class SIMPLE_API OpenGLTexture : public Texture
 		{
 			public:
+				/**
+				 * <p>
+				 * Where copies of the texture's pixels are kept once it has been uploaded to the GPU.
+				 * </p>
+				 */
+				enum class Residency
+				{
+					/**
+					 * <p>
+					 * The CPU copy is kept alongside the GPU copy. This is the only policy that allows the texture to
+					 * be evicted by the OpenGLTextureManager. Encoded sources (image files and containers) are only
+					 * kept while a texture memory budget is set, otherwise they are released once uploaded.
+					 * </p>
+					 */
+					CPU_AND_GPU,
+
+					/**
+					 * <p>
+					 * The CPU copy is released once uploaded. getRawData() reads the pixels back from the GPU when
+					 * called and keeps them until the texture is next applied, use getRawDataAsync() to avoid
+					 * stalling.
+					 * </p>
+					 */
+					CPU_ON_DEMAND,
+
+					/**
+					 * <p>
+					 * The CPU copy is released once uploaded and the pixels are never read back.
+					 * </p>
+					 */
+					GPU_ONLY
+				};
+
 				/**
 				 * @param data The texture data.
 				 * @param length The length of the data.
@@ -62,40 +100,155 @@ namespace simplicity
 
 				void apply() override;
 
+				/**
+				 * <p>
+				 * Creates a texture to attach to a frame buffer as its depth (and stencil) buffer, so that later passes
+				 * can sample the depth without copying it. Its pixel format reports RGBA, the size of each pixel.
+				 * </p>
+				 *
+				 * @param width The width of the texture.
+				 * @param height The height of the texture.
+				 * @param internalFormat The sized OpenGL depth format (e.g. GL_DEPTH24_STENCIL8 or
+				 * GL_DEPTH_COMPONENT32F).
+				 *
+				 * @return The texture.
+				 */
+				static std::shared_ptr<OpenGLTexture> createDepthTexture(unsigned int width, unsigned int height,
+						GLenum internalFormat);
+
+				/**
+				 * <p>
+				 * Releases the GPU copy of this texture, it will be uploaded again from its source the next time it is
+				 * applied. Only evictable textures can be evicted.
+				 * </p>
+				 */
+				void evict();
+
+				/**
+				 * @return The amount of CPU memory used by this texture's copy of its pixels (encoded or raw).
+				 */
+				std::size_t getCPUMemorySize() const;
+
 				unsigned int getHeight() const override;
 
+				/**
+				 * @return The (estimated) amount of GPU memory used by this texture, including all mip levels.
+				 */
+				std::size_t getMemorySize() const;
+
+				/**
+				 * @return The OpenGL internal format the texture is stored in, e.g. for allocating matching
+				 * multisampled storage to resolve into it.
+				 */
+				GLenum getOpenGLInternalPixelFormat() const;
+
 				PixelFormat getPixelFormat() const override;
 
 				const char* getRawData() const override;
 
+				/**
+				 * <p>
+				 * Reads the texture's pixels back from the GPU without stalling the CPU. Unlike getRawData(), the
+				 * texture's own copy of the pixels is left untouched.
+				 * </p>
+				 *
+				 * @return The pixel data, available once the GPU has finished writing it (see OpenGLTextureReadback).
+				 */
+				std::future<std::vector<char>> getRawDataAsync() const;
+
+				Residency getResidency() const;
+
+				/**
+				 * @return The OpenGL texture target, textures loaded from KTX/DDS containers can be cube maps or
+				 * arrays.
+				 */
+				GLenum getTarget() const;
+
 				GLuint getTexture() const;
 
 				unsigned int getWidth() const override;
 
 				void init() override;
 
+				/**
+				 * @return True if this texture retains a source it can be uploaded again from, false otherwise.
+				 */
+				bool isEvictable() const;
+
+				/**
+				 * @return True if this is a depth (and stencil) texture, false otherwise.
+				 */
+				bool isDepth() const;
+
+				/**
+				 * @return True if the texture has been uploaded to the GPU, false otherwise.
+				 */
+				bool isInitialized() const;
+
+				/**
+				 * <p>
+				 * Reallocates the texture at a new size, keeping its name so that anything it is attached to (e.g. a
+				 * frame buffer) does not need to be rebuilt. The contents are discarded. Only textures created from raw
+				 * data (e.g. render targets) can be resized.
+				 * </p>
+				 *
+				 * @param width The new width.
+				 * @param height The new height.
+				 */
+				void resize(unsigned int width, unsigned int height);
+
 				void setRawData(const char* rawData) override;
 
+				/**
+				 * <p>
+				 * Sets where copies of the texture's pixels are kept. The policy is applied when the texture is
+				 * uploaded so it needs to be set before the texture is initialized.
+				 * </p>
+				 *
+				 * @param residency Where copies of the texture's pixels are kept.
+				 */
+				void setResidency(Residency residency);
+
 			private:
+				std::size_t containerSize;
+
 				std::string data;
 
+				GLenum depthFormat;
+
 				mutable bool dirty;
 
+				bool evictable;
+
 				PixelFormat format;
 
 				unsigned int height;
 
 				bool initialized;
 
-				char* rawData;
+				unsigned int levelCount;
+
+				mutable char* rawData;
+
+				Residency residency;
+
+				GLenum target;
 
 				GLuint texture;
 
 				unsigned int width;
 
-				GLenum getOpenGLInternalPixelFormat() const;
+				unsigned int getOpenGLInternalPixelSize() const;
 
 				GLenum getOpenGLPixelFormat() const;
+
+				unsigned int getOpenGLPixelSize() const;
+
+				GLenum getOpenGLPixelType() const;
+
+				void releaseSource();
+
+				void upload(const TextureContainer::Contents& contents);
 		};
 	}
 }
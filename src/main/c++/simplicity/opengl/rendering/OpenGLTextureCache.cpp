@@ -0,0 +1,230 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+
+#include <simplicity/logging/Logs.h>
+
+#include "../common/Hash.h"
+#include "OpenGLTextureCache.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace OpenGLTextureCache
+		{
+			namespace
+			{
+				const char MAGIC[4] = { 'S', 'T', 'X', 'C' };
+
+				const uint32_t VERSION = 1;
+
+				struct FileHeader
+				{
+					char magic[4];
+
+					uint32_t version;
+
+					uint32_t alignment;
+
+					uint32_t compressed;
+
+					uint32_t format;
+
+					uint32_t internalFormat;
+
+					uint32_t type;
+
+					uint32_t levelCount;
+				};
+
+				struct FileLevel
+				{
+					uint32_t width;
+
+					uint32_t height;
+
+					uint64_t offset;
+
+					uint64_t size;
+				};
+
+				string directory;
+
+				Statistics statistics;
+
+				string getPath(uint64_t key)
+				{
+					char fileName[32];
+					snprintf(fileName, sizeof(fileName), "%016llx.stc", static_cast<unsigned long long>(key));
+
+					return directory + "/" + fileName;
+				}
+			}
+
+			Statistics::Statistics() :
+				hits(0),
+				misses(0),
+				stores(0)
+			{
+			}
+
+			unique_ptr<Entry> find(uint64_t key)
+			{
+				if (!isEnabled())
+				{
+					return nullptr;
+				}
+
+				unique_ptr<MappedFile> file(new MappedFile(getPath(key)));
+				if (!file->isOpen() || file->getSize() < sizeof(FileHeader))
+				{
+					statistics.misses++;
+					return nullptr;
+				}
+
+				const FileHeader* header = reinterpret_cast<const FileHeader*>(file->getData());
+				if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+					header->levelCount == 0 ||
+					file->getSize() < sizeof(FileHeader) + header->levelCount * sizeof(FileLevel))
+				{
+					statistics.misses++;
+					return nullptr;
+				}
+
+				unique_ptr<Entry> entry(new Entry);
+				entry->description.alignment = header->alignment;
+				entry->description.compressed = header->compressed != 0;
+				entry->description.format = header->format;
+				entry->description.internalFormat = header->internalFormat;
+				entry->description.type = header->type;
+
+				const FileLevel* fileLevels = reinterpret_cast<const FileLevel*>(header + 1);
+				for (unsigned int index = 0; index < header->levelCount; index++)
+				{
+					const FileLevel& fileLevel = fileLevels[index];
+					if (fileLevel.offset > file->getSize() || fileLevel.size > file->getSize() - fileLevel.offset)
+					{
+						Logs::warning("simplicity::opengl", "Ignoring truncated texture cache entry %s",
+								getPath(key).c_str());
+						statistics.misses++;
+						return nullptr;
+					}
+
+					Level level;
+					level.data = file->getData() + fileLevel.offset;
+					level.height = fileLevel.height;
+					level.size = fileLevel.size;
+					level.width = fileLevel.width;
+					entry->levels.push_back(level);
+				}
+
+				entry->file = move(file);
+				statistics.hits++;
+
+				return entry;
+			}
+
+			const string& getDirectory()
+			{
+				return directory;
+			}
+
+			Statistics getStatistics()
+			{
+				return statistics;
+			}
+
+			uint64_t hash(const char* data, size_t length, uint64_t seed)
+			{
+				return Hash::fnv1a(data, length, seed);
+			}
+
+			bool isEnabled()
+			{
+				return !directory.empty();
+			}
+
+			void setDirectory(const string& directory)
+			{
+				OpenGLTextureCache::directory = directory;
+			}
+
+			void store(uint64_t key, const Description& description, const vector<Level>& levels)
+			{
+				if (!isEnabled() || levels.empty())
+				{
+					return;
+				}
+
+				FileHeader header;
+				memcpy(header.magic, MAGIC, sizeof(MAGIC));
+				header.version = VERSION;
+				header.alignment = description.alignment;
+				header.compressed = description.compressed ? 1 : 0;
+				header.format = description.format;
+				header.internalFormat = description.internalFormat;
+				header.type = description.type;
+				header.levelCount = static_cast<uint32_t>(levels.size());
+
+				vector<FileLevel> fileLevels;
+				uint64_t offset = sizeof(FileHeader) + levels.size() * sizeof(FileLevel);
+				for (const Level& level : levels)
+				{
+					FileLevel fileLevel;
+					fileLevel.width = level.width;
+					fileLevel.height = level.height;
+					fileLevel.offset = offset;
+					fileLevel.size = level.size;
+					fileLevels.push_back(fileLevel);
+
+					offset += level.size;
+				}
+
+				// Write to a temporary file first so a crash can never leave a partial entry behind.
+				string path = getPath(key);
+				string temporaryPath = path + ".tmp";
+				{
+					ofstream file(temporaryPath, ios::binary | ios::trunc);
+					file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+					file.write(reinterpret_cast<const char*>(fileLevels.data()), fileLevels.size() * sizeof(FileLevel));
+					for (const Level& level : levels)
+					{
+						file.write(level.data, level.size);
+					}
+
+					if (!file)
+					{
+						Logs::warning("simplicity::opengl", "Failed to write texture cache entry %s", path.c_str());
+						remove(temporaryPath.c_str());
+						return;
+					}
+				}
+
+				remove(path.c_str());
+				if (rename(temporaryPath.c_str(), path.c_str()) != 0)
+				{
+					Logs::warning("simplicity::opengl", "Failed to write texture cache entry %s", path.c_str());
+					remove(temporaryPath.c_str());
+					return;
+				}
+
+				statistics.stores++;
+			}
+		}
+	}
+}
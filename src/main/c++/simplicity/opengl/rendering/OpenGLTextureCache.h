@@ -0,0 +1,150 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLTEXTURECACHE_H_
+#define OPENGLTEXTURECACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "../common/MappedFile.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * An on disk cache of decoded textures, keyed by a hash of the encoded texture's contents. Cached textures are
+		 * stored in a simple container that is memory mapped when read so the pixels can be uploaded straight from the
+		 * mapping. The cache is disabled until a directory is set.
+		 * </p>
+		 */
+		namespace OpenGLTextureCache
+		{
+			/**
+			 * <p>
+			 * A single (mip) level of a cached texture.
+			 * </p>
+			 */
+			struct SIMPLE_API Level
+			{
+				const char* data;
+
+				unsigned int height;
+
+				std::size_t size;
+
+				unsigned int width;
+			};
+
+			/**
+			 * <p>
+			 * Describes how the levels of a cached texture are to be uploaded.
+			 * </p>
+			 */
+			struct SIMPLE_API Description
+			{
+				unsigned int alignment;
+
+				bool compressed;
+
+				GLenum format;
+
+				GLenum internalFormat;
+
+				GLenum type;
+			};
+
+			/**
+			 * <p>
+			 * A cached texture. The levels point into the mapped file and are only valid while the entry exists.
+			 * </p>
+			 */
+			struct SIMPLE_API Entry
+			{
+				Description description;
+
+				std::unique_ptr<MappedFile> file;
+
+				std::vector<Level> levels;
+			};
+
+			/**
+			 * <p>
+			 * Cache statistics.
+			 * </p>
+			 */
+			struct SIMPLE_API Statistics
+			{
+				Statistics();
+
+				unsigned int hits;
+
+				unsigned int misses;
+
+				unsigned int stores;
+			};
+
+			/**
+			 * <p>
+			 * Retrieves a texture from the cache.
+			 * </p>
+			 *
+			 * @param key The key of the texture.
+			 *
+			 * @return The cached texture or null if the cache is disabled or has no (valid) entry for the key.
+			 */
+			SIMPLE_API std::unique_ptr<Entry> find(std::uint64_t key);
+
+			/**
+			 * @return The directory the cache is stored in, empty if the cache is disabled.
+			 */
+			SIMPLE_API const std::string& getDirectory();
+
+			SIMPLE_API Statistics getStatistics();
+
+			/**
+			 * <p>
+			 * Hashes the encoded contents of a texture (64 bit FNV-1a).
+			 * </p>
+			 */
+			SIMPLE_API std::uint64_t hash(const char* data, std::size_t length, std::uint64_t seed = 0);
+
+			/**
+			 * @return True if a directory has been set, false otherwise.
+			 */
+			SIMPLE_API bool isEnabled();
+
+			/**
+			 * @param directory The (existing) directory to store the cache in, empty to disable the cache.
+			 */
+			SIMPLE_API void setDirectory(const std::string& directory);
+
+			/**
+			 * <p>
+			 * Stores a texture in the cache. Does nothing if the cache is disabled.
+			 * </p>
+			 *
+			 * @param key The key of the texture.
+			 * @param description Describes how the levels are to be uploaded.
+			 * @param levels The levels of the texture, starting from the base level.
+			 */
+			SIMPLE_API void store(std::uint64_t key, const Description& description, const std::vector<Level>& levels);
+		}
+	}
+}
+
+#endif /* OPENGLTEXTURECACHE_H_ */
@@ -0,0 +1,242 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <list>
+#include <map>
+
+#include <simplicity/logging/Logs.h>
+
+#include "OpenGLTexture.h"
+#include "OpenGLTextureManager.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace OpenGLTextureManager
+		{
+			namespace
+			{
+				struct Entry
+				{
+					unsigned long lastAppliedFrame;
+
+					// Only valid for evictable textures.
+					list<OpenGLTexture*>::iterator lruPosition;
+
+					bool resident;
+
+					size_t size;
+				};
+
+				unsigned long currentFrame = 0;
+
+				map<OpenGLTexture*, Entry> entries;
+
+				// Least recently applied at the front.
+				list<OpenGLTexture*> lru;
+
+				bool overBudgetReported = false;
+
+				Statistics statistics;
+
+				void enforceBudget()
+				{
+					if (statistics.budget == 0)
+					{
+						return;
+					}
+
+					while (statistics.residentBytes > statistics.budget && !lru.empty())
+					{
+						OpenGLTexture* texture = lru.front();
+						Entry& entry = entries[texture];
+
+						// Everything from here on has been applied this frame, evicting it would only cause thrashing.
+						if (entry.lastAppliedFrame == currentFrame)
+						{
+							if (!overBudgetReported)
+							{
+								Logs::warning("simplicity::opengl",
+										"Texture memory budget of %zu bytes exceeded by textures in use (%zu bytes)",
+										statistics.budget, statistics.residentBytes);
+								overBudgetReported = true;
+							}
+
+							break;
+						}
+
+						lru.pop_front();
+
+						entry.resident = false;
+						statistics.evictedBytes += entry.size;
+						statistics.evictions++;
+						statistics.residentBytes -= entry.size;
+						statistics.residentTextures--;
+
+						texture->evict();
+					}
+				}
+			}
+
+			Statistics::Statistics() :
+				budget(0),
+				cpuBytes(0),
+				evictedBytes(0),
+				evictions(0),
+				peakResidentBytes(0),
+				releasedCPUBytes(0),
+				residentBytes(0),
+				residentTextures(0),
+				reuploads(0),
+				uploads(0)
+			{
+			}
+
+			size_t getBudget()
+			{
+				return statistics.budget;
+			}
+
+			Statistics getStatistics()
+			{
+				Statistics current = statistics;
+
+				current.cpuBytes = 0;
+				for (const pair<OpenGLTexture* const, Entry>& entry : entries)
+				{
+					current.cpuBytes += entry.first->getCPUMemorySize();
+				}
+
+				return current;
+			}
+
+			void logMemoryReport()
+			{
+				Statistics current = getStatistics();
+
+				Logs::info("simplicity::opengl", "Texture memory: %u textures resident using %zu bytes of GPU memory "
+						"(peak %zu, budget %zu)", current.residentTextures, current.residentBytes,
+						current.peakResidentBytes, current.budget);
+				Logs::info("simplicity::opengl", "Texture memory: %zu bytes of CPU memory held, %zu bytes released "
+						"after upload", current.cpuBytes, current.releasedCPUBytes);
+				Logs::info("simplicity::opengl", "Texture memory: %u uploads, %u re-uploads, %u evictions (%zu bytes)",
+						current.uploads, current.reuploads, current.evictions, current.evictedBytes);
+			}
+
+			void nextFrame()
+			{
+				currentFrame++;
+				overBudgetReported = false;
+			}
+
+			void onApplied(OpenGLTexture& texture)
+			{
+				auto entry = entries.find(&texture);
+				if (entry == entries.end() || entry->second.lastAppliedFrame == currentFrame)
+				{
+					return;
+				}
+
+				entry->second.lastAppliedFrame = currentFrame;
+
+				if (texture.isEvictable())
+				{
+					lru.splice(lru.end(), lru, entry->second.lruPosition);
+				}
+			}
+
+			void onReleased(OpenGLTexture& texture)
+			{
+				auto entry = entries.find(&texture);
+				if (entry == entries.end())
+				{
+					return;
+				}
+
+				if (entry->second.resident)
+				{
+					statistics.residentBytes -= entry->second.size;
+					statistics.residentTextures--;
+
+					if (texture.isEvictable())
+					{
+						lru.erase(entry->second.lruPosition);
+					}
+				}
+
+				entries.erase(entry);
+			}
+
+			void onSourceReleased(size_t size)
+			{
+				statistics.releasedCPUBytes += size;
+			}
+
+			void onUploaded(OpenGLTexture& texture)
+			{
+				auto existing = entries.find(&texture);
+				if (existing != entries.end())
+				{
+					if (existing->second.resident)
+					{
+						// Uploaded again in place (e.g. setRawData()), only the size can have changed.
+						statistics.residentBytes -= existing->second.size;
+						existing->second.size = texture.getMemorySize();
+						statistics.residentBytes += existing->second.size;
+						enforceBudget();
+						return;
+					}
+
+					statistics.reuploads++;
+				}
+
+				Entry& entry = entries[&texture];
+				entry.lastAppliedFrame = currentFrame;
+				entry.resident = true;
+				entry.size = texture.getMemorySize();
+
+				if (texture.isEvictable())
+				{
+					entry.lruPosition = lru.insert(lru.end(), &texture);
+				}
+
+				statistics.residentBytes += entry.size;
+				statistics.residentTextures++;
+				statistics.uploads++;
+				if (statistics.residentBytes > statistics.peakResidentBytes)
+				{
+					statistics.peakResidentBytes = statistics.residentBytes;
+				}
+
+				enforceBudget();
+			}
+
+			void resetStatistics()
+			{
+				statistics.evictedBytes = 0;
+				statistics.evictions = 0;
+				statistics.peakResidentBytes = statistics.residentBytes;
+				statistics.releasedCPUBytes = 0;
+				statistics.reuploads = 0;
+				statistics.uploads = 0;
+			}
+
+			void setBudget(size_t budget)
+			{
+				statistics.budget = budget;
+				enforceBudget();
+			}
+		}
+	}
+}
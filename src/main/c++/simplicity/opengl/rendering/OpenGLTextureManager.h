@@ -0,0 +1,148 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLTEXTUREMANAGER_H_
+#define OPENGLTEXTUREMANAGER_H_
+
+#include <cstddef>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		class OpenGLTexture;
+
+		/**
+		 * <p>
+		 * Keeps track of how much GPU memory is used by textures and keeps it within a budget. When the budget is
+		 * exceeded the least recently applied textures are evicted from the GPU, they are uploaded again from their
+		 * retained source the next time they are applied. Textures that have no source to upload from (e.g. frame
+		 * buffer attachments) are accounted for but are never evicted.
+		 * </p>
+		 */
+		namespace OpenGLTextureManager
+		{
+			/**
+			 * <p>
+			 * Residency and eviction statistics.
+			 * </p>
+			 */
+			struct SIMPLE_API Statistics
+			{
+				Statistics();
+
+				std::size_t budget;
+
+				/**
+				 * <p>
+				 * The CPU memory held by uploaded textures for copies of their pixels.
+				 * </p>
+				 */
+				std::size_t cpuBytes;
+
+				std::size_t evictedBytes;
+
+				unsigned int evictions;
+
+				std::size_t peakResidentBytes;
+
+				/**
+				 * <p>
+				 * The CPU memory saved by textures releasing their copies of their pixels once uploaded (see
+				 * OpenGLTexture::Residency).
+				 * </p>
+				 */
+				std::size_t releasedCPUBytes;
+
+				std::size_t residentBytes;
+
+				unsigned int residentTextures;
+
+				unsigned int reuploads;
+
+				unsigned int uploads;
+			};
+
+			/**
+			 * @return The texture memory budget in bytes, 0 means unlimited.
+			 */
+			SIMPLE_API std::size_t getBudget();
+
+			/**
+			 * @return The current residency and eviction statistics.
+			 */
+			SIMPLE_API Statistics getStatistics();
+
+			/**
+			 * <p>
+			 * Logs a summary of the CPU and GPU memory used by textures.
+			 * </p>
+			 */
+			SIMPLE_API void logMemoryReport();
+
+			/**
+			 * <p>
+			 * Marks the start of a new frame. Textures applied in the current frame are never evicted.
+			 * </p>
+			 */
+			SIMPLE_API void nextFrame();
+
+			/**
+			 * <p>
+			 * Notifies the manager that a texture has been applied. Called by OpenGLTexture.
+			 * </p>
+			 */
+			SIMPLE_API void onApplied(OpenGLTexture& texture);
+
+			/**
+			 * <p>
+			 * Notifies the manager that a texture has been destroyed. Called by OpenGLTexture.
+			 * </p>
+			 */
+			SIMPLE_API void onReleased(OpenGLTexture& texture);
+
+			/**
+			 * <p>
+			 * Notifies the manager that a texture has released its CPU copy of its pixels. Called by OpenGLTexture.
+			 * </p>
+			 */
+			SIMPLE_API void onSourceReleased(std::size_t size);
+
+			/**
+			 * <p>
+			 * Notifies the manager that a texture has been uploaded to the GPU. Called by OpenGLTexture.
+			 * </p>
+			 */
+			SIMPLE_API void onUploaded(OpenGLTexture& texture);
+
+			/**
+			 * <p>
+			 * Resets the cumulative counters (evictions, uploads etc.) but not the residency.
+			 * </p>
+			 */
+			SIMPLE_API void resetStatistics();
+
+			/**
+			 * <p>
+			 * Textures only keep their encoded sources to be uploaded from again while a budget is set, so set it
+			 * before textures are initialized. Textures initialized without a budget cannot be evicted.
+			 * </p>
+			 *
+			 * @param budget The texture memory budget in bytes, 0 means unlimited.
+			 */
+			SIMPLE_API void setBudget(std::size_t budget);
+		}
+	}
+}
+
+#endif /* OPENGLTEXTUREMANAGER_H_ */
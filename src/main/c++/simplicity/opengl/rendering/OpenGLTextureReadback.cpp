@@ -0,0 +1,136 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <string.h>
+
+#include <algorithm>
+
+#include "../common/OpenGL.h"
+#include "OpenGLTextureReadback.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace
+		{
+			vector<unique_ptr<OpenGLTextureReadback>> pendingReadbacks;
+		}
+
+		OpenGLTextureReadback::OpenGLTextureReadback(GLuint texture, GLenum format, GLenum type, unsigned int size) :
+			buffer(0),
+			completed(false),
+			fence(nullptr),
+			promise(),
+			size(size)
+		{
+			glGenBuffers(1, &buffer);
+			OpenGL::checkError();
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+			OpenGL::checkError();
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+			OpenGL::checkError();
+
+			// Rows are tightly packed in the CPU side copy regardless of the pixel depth.
+			GLint packAlignment = 4;
+			glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+			OpenGL::checkError();
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			OpenGL::checkError();
+
+			// With a pack buffer bound the pixels are written to offset 0 of the buffer and the call returns
+			// immediately.
+			glBindTexture(GL_TEXTURE_2D, texture);
+			OpenGL::checkError();
+			glGetTexImage(GL_TEXTURE_2D, 0, format, type, nullptr);
+			OpenGL::checkError();
+			glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+			OpenGL::checkError();
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			OpenGL::checkError();
+
+			fence.reset(new OpenGLFence);
+
+			// Make sure the read is actually submitted so the fence can be signaled without anyone flushing.
+			glFlush();
+			OpenGL::checkError();
+		}
+
+		OpenGLTextureReadback::~OpenGLTextureReadback()
+		{
+			glDeleteBuffers(1, &buffer);
+			OpenGL::checkError();
+		}
+
+		future<vector<char>> OpenGLTextureReadback::issue(GLuint texture, GLenum format, GLenum type,
+				unsigned int size)
+		{
+			unique_ptr<OpenGLTextureReadback> readback(new OpenGLTextureReadback(texture, format, type, size));
+			future<vector<char>> result = readback->promise.get_future();
+			pendingReadbacks.push_back(move(readback));
+
+			return result;
+		}
+
+		bool OpenGLTextureReadback::tryComplete(bool wait)
+		{
+			if (completed)
+			{
+				return true;
+			}
+
+			if (wait)
+			{
+				fence->wait();
+			}
+			else if (!fence->isSignaled())
+			{
+				return false;
+			}
+
+			vector<char> data(size);
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+			OpenGL::checkError();
+			const void* mappedData = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+			OpenGL::checkError();
+
+			if (mappedData != nullptr)
+			{
+				memcpy(data.data(), mappedData, size);
+			}
+
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			OpenGL::checkError();
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			OpenGL::checkError();
+
+			promise.set_value(move(data));
+			completed = true;
+
+			return true;
+		}
+
+		void OpenGLTextureReadback::update(bool wait)
+		{
+			pendingReadbacks.erase(
+					remove_if(pendingReadbacks.begin(), pendingReadbacks.end(),
+							[wait](const unique_ptr<OpenGLTextureReadback>& readback)
+							{
+								return readback->tryComplete(wait);
+							}),
+					pendingReadbacks.end());
+		}
+	}
+}
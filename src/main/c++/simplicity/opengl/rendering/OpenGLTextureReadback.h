@@ -0,0 +1,103 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLTEXTUREREADBACK_H_
+#define OPENGLTEXTUREREADBACK_H_
+
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <simplicity/common/Defines.h>
+
+#include "../common/OpenGLFence.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * An asynchronous read of a texture's pixels back to the CPU. The read is issued into a pixel pack buffer and
+		 * the buffer is only mapped once the GPU has signaled the fence that follows it, so the CPU never stalls
+		 * waiting for the GPU.
+		 * </p>
+		 *
+		 * <p>
+		 * Pending readbacks are completed by calling update() once per frame on the rendering thread (the
+		 * OpenGLRenderingEngine does this for you). Waiting on the future on the rendering thread without calling
+		 * update() will never return.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLTextureReadback
+		{
+			public:
+				/**
+				 * @param texture The name of the texture to read.
+				 * @param format The OpenGL format of the pixels to read.
+				 * @param type The OpenGL type of the pixels to read.
+				 * @param size The size of the pixel data in bytes.
+				 */
+				OpenGLTextureReadback(GLuint texture, GLenum format, GLenum type, unsigned int size);
+
+				~OpenGLTextureReadback();
+
+				OpenGLTextureReadback(const OpenGLTextureReadback&) = delete;
+
+				OpenGLTextureReadback& operator=(const OpenGLTextureReadback&) = delete;
+
+				/**
+				 * <p>
+				 * Issues a read of the given texture and registers it to be completed by update().
+				 * </p>
+				 *
+				 * @return The pixel data, available once the GPU has finished writing it.
+				 */
+				static std::future<std::vector<char>> issue(GLuint texture, GLenum format, GLenum type,
+						unsigned int size);
+
+				/**
+				 * <p>
+				 * Completes the read if the GPU has finished writing the pixel data.
+				 * </p>
+				 *
+				 * @param wait Block until the GPU has finished writing the pixel data.
+				 *
+				 * @return True if the read has been completed, false otherwise.
+				 */
+				bool tryComplete(bool wait = false);
+
+				/**
+				 * <p>
+				 * Completes all the pending reads that the GPU has finished writing.
+				 * </p>
+				 *
+				 * @param wait Block until all the pending reads have been completed.
+				 */
+				static void update(bool wait = false);
+
+			private:
+				GLuint buffer;
+
+				bool completed;
+
+				std::unique_ptr<OpenGLFence> fence;
+
+				std::promise<std::vector<char>> promise;
+
+				unsigned int size;
+		};
+	}
+}
+
+#endif /* OPENGLTEXTUREREADBACK_H_ */
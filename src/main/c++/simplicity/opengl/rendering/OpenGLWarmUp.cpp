@@ -0,0 +1,239 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <algorithm>
+#include <chrono>
+
+#include <simplicity/logging/Logs.h>
+
+#include "OpenGLWarmUp.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		OpenGLWarmUp::OpenGLWarmUp() :
+			budgetFrames(0),
+			budgetMilliseconds(0.0),
+			frameBuffers(),
+			framesLeft(0),
+			linkingPipelines(),
+			pipelines(),
+			textures(),
+			variantFeatureSets()
+		{
+		}
+
+		void OpenGLWarmUp::add(const vector<shared_ptr<Pipeline>>& pipelines,
+				const vector<shared_ptr<Texture>>& textures, const vector<FrameBuffer*>& frameBuffers)
+		{
+			for (FrameBuffer* frameBuffer : frameBuffers)
+			{
+				OpenGLFrameBuffer* openGLFrameBuffer = dynamic_cast<OpenGLFrameBuffer*>(frameBuffer);
+				if (openGLFrameBuffer == nullptr)
+				{
+					Logs::warning("simplicity::opengl",
+							"Skipping warm up of a frame buffer not implemented using OpenGL");
+					continue;
+				}
+
+				this->frameBuffers.push_back(openGLFrameBuffer);
+			}
+
+			for (const shared_ptr<Pipeline>& pipeline : pipelines)
+			{
+				shared_ptr<OpenGLPipeline> openGLPipeline = dynamic_pointer_cast<OpenGLPipeline>(pipeline);
+				if (openGLPipeline == nullptr)
+				{
+					Logs::warning("simplicity::opengl", "Skipping warm up of a pipeline not implemented using OpenGL");
+					continue;
+				}
+
+				this->pipelines.push_back(openGLPipeline);
+			}
+
+			for (const shared_ptr<Texture>& texture : textures)
+			{
+				shared_ptr<OpenGLTexture> openGLTexture = dynamic_pointer_cast<OpenGLTexture>(texture);
+				if (openGLTexture == nullptr)
+				{
+					Logs::warning("simplicity::opengl", "Skipping warm up of a texture not implemented using OpenGL");
+					continue;
+				}
+
+				this->textures.push_back(openGLTexture);
+			}
+
+			framesLeft = budgetFrames;
+		}
+
+		OpenGLWarmUp::Status OpenGLWarmUp::getStatus() const
+		{
+			Status status;
+
+			for (OpenGLFrameBuffer* frameBuffer : frameBuffers)
+			{
+				if (!frameBuffer->isInitialized())
+				{
+					status.coldFrameBuffers.push_back(frameBuffer);
+				}
+			}
+
+			// Variants are reported as the pipeline that was added, once however many of its variants are cold.
+			for (const LinkingPipeline& pipeline : linkingPipelines)
+			{
+				if (find(status.coldPipelines.begin(), status.coldPipelines.end(), pipeline.owner.get()) ==
+						status.coldPipelines.end())
+				{
+					status.coldPipelines.push_back(pipeline.owner.get());
+				}
+			}
+
+			for (const shared_ptr<OpenGLPipeline>& pipeline : pipelines)
+			{
+				if (!pipeline->isLinked() &&
+						find(status.coldPipelines.begin(), status.coldPipelines.end(), pipeline.get()) ==
+						status.coldPipelines.end())
+				{
+					status.coldPipelines.push_back(pipeline.get());
+				}
+			}
+
+			for (const shared_ptr<OpenGLTexture>& texture : textures)
+			{
+				if (!texture->isInitialized())
+				{
+					status.coldTextures.push_back(texture.get());
+				}
+			}
+
+			return status;
+		}
+
+		void OpenGLWarmUp::setBudget(unsigned int frames, double milliseconds)
+		{
+			budgetFrames = frames;
+			budgetMilliseconds = milliseconds;
+			framesLeft = frames;
+		}
+
+		void OpenGLWarmUp::setVariants(const vector<unsigned int>& featureSets)
+		{
+			variantFeatureSets = featureSets;
+		}
+
+		bool OpenGLWarmUp::update()
+		{
+			bool parallel = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+			bool frameBufferChanged = false;
+
+			// Pipelines submitted on earlier frames are linked as soon as the driver has finished with them, this
+			// does not block so it is not counted against the budget.
+			for (auto pipeline = linkingPipelines.begin(); pipeline != linkingPipelines.end();)
+			{
+				if (pipeline->pipeline->isReady())
+				{
+					pipeline->pipeline->link();
+					pipeline = linkingPipelines.erase(pipeline);
+				}
+				else
+				{
+					pipeline++;
+				}
+			}
+
+			size_t remaining = frameBuffers.size() + pipelines.size() + textures.size();
+			if (remaining == 0)
+			{
+				return false;
+			}
+
+			// Without a frame budget everything goes now (unless there is a time budget).
+			size_t quota = remaining;
+			if (framesLeft > 0)
+			{
+				quota = (remaining + framesLeft - 1) / framesLeft;
+				framesLeft--;
+			}
+
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (size_t item = 0; item < quota; item++)
+			{
+				if (item > 0 && budgetMilliseconds > 0.0 &&
+					chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() >= budgetMilliseconds)
+				{
+					break;
+				}
+
+				// Pipelines first so the driver can compile them while the rest is being done.
+				if (!pipelines.empty())
+				{
+					shared_ptr<OpenGLPipeline> pipeline = pipelines.front();
+					pipelines.pop_front();
+
+					// The variants are what actually gets drawn with, submit them all before waiting on any.
+					vector<OpenGLPipeline*> submitted = { pipeline.get() };
+					pipeline->compile();
+					for (unsigned int features : variantFeatureSets)
+					{
+						// Pipelines without features are their own variant.
+						OpenGLPipeline& variant = pipeline->getVariant(features);
+						if (find(submitted.begin(), submitted.end(), &variant) == submitted.end())
+						{
+							variant.compile();
+							submitted.push_back(&variant);
+						}
+					}
+
+					for (OpenGLPipeline* submittedPipeline : submitted)
+					{
+						if (parallel && !submittedPipeline->isReady())
+						{
+							linkingPipelines.push_back({ pipeline, submittedPipeline });
+						}
+						else
+						{
+							submittedPipeline->link();
+						}
+					}
+				}
+				else if (!textures.empty())
+				{
+					shared_ptr<OpenGLTexture> texture = textures.front();
+					if (!texture->isInitialized())
+					{
+						texture->init();
+					}
+					textures.pop_front();
+				}
+				else if (!frameBuffers.empty())
+				{
+					OpenGLFrameBuffer* frameBuffer = frameBuffers.front();
+					if (!frameBuffer->isInitialized())
+					{
+						frameBuffer->init();
+						frameBufferChanged = true;
+					}
+					frameBuffers.pop_front();
+				}
+			}
+
+			return frameBufferChanged;
+		}
+
+		bool OpenGLWarmUp::Status::isComplete() const
+		{
+			return coldFrameBuffers.empty() && coldPipelines.empty() && coldTextures.empty();
+		}
+	}
+}
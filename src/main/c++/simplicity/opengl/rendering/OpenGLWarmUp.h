@@ -0,0 +1,149 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef OPENGLWARMUP_H_
+#define OPENGLWARMUP_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <simplicity/rendering/FrameBuffer.h>
+#include <simplicity/rendering/Pipeline.h>
+#include <simplicity/rendering/Texture.h>
+
+#include "OpenGLFrameBuffer.h"
+#include "OpenGLPipeline.h"
+#include "OpenGLTexture.h"
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Initializes pipelines, textures and frame buffers ahead of their first use so that the first frame to use
+		 * them does not pay to compile, link, upload or create them. The work is spread over a number of frames or
+		 * limited to a time budget per frame.
+		 * </p>
+		 */
+		class SIMPLE_API OpenGLWarmUp
+		{
+			public:
+				/**
+				 * <p>
+				 * What is still cold, i.e. has not been initialized yet.
+				 * </p>
+				 */
+				struct SIMPLE_API Status
+				{
+					std::vector<FrameBuffer*> coldFrameBuffers;
+
+					/**
+					 * <p>
+					 * The pipelines that were added, each listed once while it or any of its variants is cold.
+					 * </p>
+					 */
+					std::vector<Pipeline*> coldPipelines;
+
+					std::vector<Texture*> coldTextures;
+
+					/**
+					 * @return True if nothing is cold, false otherwise.
+					 */
+					bool isComplete() const;
+				};
+
+				OpenGLWarmUp();
+
+				/**
+				 * <p>
+				 * Adds to what is to be warmed up. The frame buffers must outlive the warm up, the pipelines and
+				 * textures are kept alive until they are warm. Anything not implemented using OpenGL is skipped.
+				 * </p>
+				 *
+				 * @param pipelines The pipelines to compile and link.
+				 * @param textures The textures to upload.
+				 * @param frameBuffers The frame buffers to create.
+				 */
+				void add(const std::vector<std::shared_ptr<Pipeline>>& pipelines,
+						const std::vector<std::shared_ptr<Texture>>& textures,
+						const std::vector<FrameBuffer*>& frameBuffers);
+
+				/**
+				 * @return What is still cold.
+				 */
+				Status getStatus() const;
+
+				/**
+				 * <p>
+				 * Sets how the work is spread. With a number of frames the work is divided evenly between them, with a
+				 * time budget no more work is started in a frame once the budget has been spent (at least one item is
+				 * always warmed per frame). With neither, everything is warmed up in the next frame.
+				 * </p>
+				 *
+				 * @param frames The number of frames to spread the work over, 0 for no limit.
+				 * @param milliseconds The time to spend per frame, 0 for no limit.
+				 */
+				void setBudget(unsigned int frames, double milliseconds);
+
+				/**
+				 * <p>
+				 * Sets the variants compiled along with each pipeline. The OpenGLRenderingEngine sets the ones it draws
+				 * models with.
+				 * </p>
+				 *
+				 * @param featureSets The bitmasks of OpenGLPipeline::Features of the variants.
+				 */
+				void setVariants(const std::vector<unsigned int>& featureSets);
+
+				/**
+				 * <p>
+				 * Does this frame's share of the work.
+				 * </p>
+				 *
+				 * @return True if the current frame buffer binding was changed, false otherwise.
+				 */
+				bool update();
+
+			private:
+				/**
+				 * <p>
+				 * A pipeline (or one of its variants) submitted for compilation, waiting for the driver.
+				 * </p>
+				 */
+				struct LinkingPipeline
+				{
+					std::shared_ptr<OpenGLPipeline> owner;
+
+					OpenGLPipeline* pipeline;
+				};
+
+				unsigned int budgetFrames;
+
+				double budgetMilliseconds;
+
+				std::deque<OpenGLFrameBuffer*> frameBuffers;
+
+				unsigned int framesLeft;
+
+				std::vector<LinkingPipeline> linkingPipelines;
+
+				std::deque<std::shared_ptr<OpenGLPipeline>> pipelines;
+
+				std::deque<std::shared_ptr<OpenGLTexture>> textures;
+
+				std::vector<unsigned int> variantFeatureSets;
+		};
+	}
+}
+
+#endif /* OPENGLWARMUP_H_ */
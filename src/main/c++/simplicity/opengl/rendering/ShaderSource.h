@@ -25,6 +25,214 @@ namespace simplicity
 	{
 		namespace ShaderSource
 		{
+			// Separable Gaussian blur (the same weights as fragmentGaussian.glsl) for the compute path. Each work group
+			// loads its pixels plus an apron of RADIUS pixels into shared memory once, so every tap after that is a
+			// shared memory read instead of a texture fetch. BOTH_DIRECTIONS blurs horizontally into a second shared
+			// tile and then vertically, all in one dispatch.
+			std::string computeGaussianBlur =
+					"#version 430\n"
+
+					"// /////////////////////////\n"
+					"// Variables\n"
+					"// /////////////////////////\n"
+
+					"const int RADIUS = 4;\n"
+					"const float WEIGHTS[RADIUS + 1] =\n"
+					"		float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);\n"
+
+					"layout(binding = 0) uniform sampler2D source;\n"
+					"layout(binding = 0, rgba16f) uniform writeonly image2D target;\n"
+
+					"// /////////////////////////\n"
+					"// Shader\n"
+					"// /////////////////////////\n"
+
+					"// Reads the source at the target's resolution, clamped to its edges.\n"
+					"vec3 fetch(ivec2 pixel)\n"
+					"{\n"
+					"	ivec2 size = imageSize(target);\n"
+					"	pixel = clamp(pixel, ivec2(0), size - 1);\n"
+					"	return textureLod(source, (vec2(pixel) + 0.5) / vec2(size), 0.0).rgb;\n"
+					"}\n"
+
+					"#ifdef BOTH_DIRECTIONS\n"
+					"const int TILE_SIZE = 16;\n"
+					"const int APRON_SIZE = TILE_SIZE + 2 * RADIUS;\n"
+					"layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;\n"
+
+					"// The group's pixels with an apron on every side, then the same blurred horizontally.\n"
+					"shared vec3 tile[APRON_SIZE][APRON_SIZE];\n"
+					"shared vec3 horizontalTile[APRON_SIZE][TILE_SIZE];\n"
+
+					"void main()\n"
+					"{\n"
+					"	ivec2 local = ivec2(gl_LocalInvocationID.xy);\n"
+					"	ivec2 origin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - RADIUS;\n"
+					"	for (int y = local.y; y < APRON_SIZE; y += TILE_SIZE)\n"
+					"	{\n"
+					"		for (int x = local.x; x < APRON_SIZE; x += TILE_SIZE)\n"
+					"		{\n"
+					"			tile[y][x] = fetch(origin + ivec2(x, y));\n"
+					"		}\n"
+					"	}\n"
+					"	barrier();\n"
+					"	for (int y = local.y; y < APRON_SIZE; y += TILE_SIZE)\n"
+					"	{\n"
+					"		vec3 sum = tile[y][local.x + RADIUS] * WEIGHTS[0];\n"
+					"		for (int offset = 1; offset <= RADIUS; offset++)\n"
+					"		{\n"
+					"			sum += (tile[y][local.x + RADIUS - offset] +\n"
+					"					tile[y][local.x + RADIUS + offset]) * WEIGHTS[offset];\n"
+					"		}\n"
+					"		horizontalTile[y][local.x] = sum;\n"
+					"	}\n"
+					"	barrier();\n"
+					"	vec3 sum = horizontalTile[local.y + RADIUS][local.x] * WEIGHTS[0];\n"
+					"	for (int offset = 1; offset <= RADIUS; offset++)\n"
+					"	{\n"
+					"		sum += (horizontalTile[local.y + RADIUS - offset][local.x] +\n"
+					"				horizontalTile[local.y + RADIUS + offset][local.x]) * WEIGHTS[offset];\n"
+					"	}\n"
+					"	ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);\n"
+					"	if (all(lessThan(pixel, imageSize(target))))\n"
+					"	{\n"
+					"		imageStore(target, pixel, vec4(sum, 1.0));\n"
+					"	}\n"
+					"}\n"
+
+					"#else\n"
+					"const int TILE_SIZE = 128;\n"
+					"layout(local_size_x = TILE_SIZE) in;\n"
+
+					"uniform int horizontal;\n"
+
+					"// The group's pixels with an apron at each end, along the blur direction.\n"
+					"shared vec3 tile[TILE_SIZE + 2 * RADIUS];\n"
+
+					"void main()\n"
+					"{\n"
+					"	int local = int(gl_LocalInvocationID.x);\n"
+					"	// Work groups run along the blur direction.\n"
+					"	ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);\n"
+					"	if (horizontal == 0)\n"
+					"	{\n"
+					"		pixel = pixel.yx;\n"
+					"	}\n"
+					"	ivec2 step = horizontal != 0 ? ivec2(1, 0) : ivec2(0, 1);\n"
+					"	tile[local + RADIUS] = fetch(pixel);\n"
+					"	if (local < RADIUS)\n"
+					"	{\n"
+					"		tile[local] = fetch(pixel - step * RADIUS);\n"
+					"		tile[local + TILE_SIZE + RADIUS] = fetch(pixel + step * TILE_SIZE);\n"
+					"	}\n"
+					"	barrier();\n"
+					"	vec3 sum = tile[local + RADIUS] * WEIGHTS[0];\n"
+					"	for (int offset = 1; offset <= RADIUS; offset++)\n"
+					"	{\n"
+					"		sum += (tile[local + RADIUS - offset] + tile[local + RADIUS + offset]) * WEIGHTS[offset];\n"
+					"	}\n"
+					"	if (all(lessThan(pixel, imageSize(target))))\n"
+					"	{\n"
+					"		imageStore(target, pixel, vec4(sum, 1.0));\n"
+					"	}\n"
+					"}\n"
+
+					"#endif";
+
+			// Halves the resolution with a 13 tap filter (five overlapping 4 tap boxes) that keeps bright spots
+			// from flickering as they move between texels.
+			std::string fragmentBloomDownsample =
+					"#version 330\n"
+
+					"// /////////////////////////\n"
+					"// Structures\n"
+					"// /////////////////////////\n"
+
+					"struct Point\n"
+					"{\n"
+					"	vec4 clipPosition;\n"
+					"	vec4 color;\n"
+					"	vec3 normal;\n"
+					"	vec2 texCoord;\n"
+					"	vec3 worldPosition;\n"
+					"};\n"
+
+					"// /////////////////////////\n"
+					"// Variables\n"
+					"// /////////////////////////\n"
+
+					"in Point point;\n"
+
+					"uniform sampler2D sampler;\n"
+					"uniform vec2 texelSize;\n"
+
+					"layout(location = 0) out vec4 color;\n"
+
+					"// /////////////////////////\n"
+					"// Shader\n"
+					"// /////////////////////////\n"
+
+					"vec3 tap(float x, float y)\n"
+					"{\n"
+					"	return texture(sampler, point.texCoord + texelSize * vec2(x, y)).rgb;\n"
+					"}\n"
+
+					"void main()\n"
+					"{\n"
+					"	vec3 outer = (tap(-2.0, 2.0) + tap(2.0, 2.0) + tap(-2.0, -2.0) + tap(2.0, -2.0)) * 0.03125;\n"
+					"	vec3 edges = (tap(0.0, 2.0) + tap(-2.0, 0.0) + tap(2.0, 0.0) + tap(0.0, -2.0)) * 0.0625;\n"
+					"	vec3 inner = (tap(-1.0, 1.0) + tap(1.0, 1.0) + tap(-1.0, -1.0) + tap(1.0, -1.0)) * 0.125;\n"
+					"	vec3 center = tap(0.0, 0.0) * 0.125;\n"
+
+					"	color = vec4(outer + edges + inner + center, 1.0);\n"
+					"}";
+
+			// Doubles the resolution with a 3x3 tent filter, meant to be blended additively onto the level above.
+			std::string fragmentBloomUpsample =
+					"#version 330\n"
+
+					"// /////////////////////////\n"
+					"// Structures\n"
+					"// /////////////////////////\n"
+
+					"struct Point\n"
+					"{\n"
+					"	vec4 clipPosition;\n"
+					"	vec4 color;\n"
+					"	vec3 normal;\n"
+					"	vec2 texCoord;\n"
+					"	vec3 worldPosition;\n"
+					"};\n"
+
+					"// /////////////////////////\n"
+					"// Variables\n"
+					"// /////////////////////////\n"
+
+					"in Point point;\n"
+
+					"uniform sampler2D sampler;\n"
+					"uniform vec2 texelSize;\n"
+
+					"layout(location = 0) out vec4 color;\n"
+
+					"// /////////////////////////\n"
+					"// Shader\n"
+					"// /////////////////////////\n"
+
+					"vec3 tap(float x, float y)\n"
+					"{\n"
+					"	return texture(sampler, point.texCoord + texelSize * vec2(x, y)).rgb;\n"
+					"}\n"
+
+					"void main()\n"
+					"{\n"
+					"	vec3 corners = tap(-1.0, 1.0) + tap(1.0, 1.0) + tap(-1.0, -1.0) + tap(1.0, -1.0);\n"
+					"	vec3 edges = tap(0.0, 1.0) + tap(-1.0, 0.0) + tap(1.0, 0.0) + tap(0.0, -1.0);\n"
+					"	vec3 center = tap(0.0, 0.0);\n"
+
+					"	color = vec4((corners + edges * 2.0 + center * 4.0) / 16.0, 1.0);\n"
+					"}";
+
 			std::string fragmentSimple =
 					"#version 330\n"
 
@@ -45,13 +253,18 @@ namespace simplicity
 					"// Variables\n"
 					"// /////////////////////////\n"
 
+					"#ifndef DEPTH_ONLY\n"
 					"in Point point;\n"
 
+					"#ifdef TEXTURED\n"
 					"uniform sampler2D sampler;\n"
-					"uniform int samplerEnabled;\n"
+					"#endif\n"
 
 					"layout(location = 0) out vec4 color;\n"
+					"#ifdef BLOOM_OUTPUT\n"
 					"layout(location = 1) out vec4 color2;\n"
+					"#endif\n"
+					"#endif\n"
 
 					"// /////////////////////////\n"
 					"// Shader\n"
@@ -59,16 +272,21 @@ namespace simplicity
 
 					"void main()\n"
 					"{\n"
-					"	if (samplerEnabled == 1)\n"
-					"	{\n"
-					"		color = texture2D(sampler, point.texCoord);\n"
-					"	}\n"
-					"	else\n"
-					"	{\n"
-					"		color = point.color;\n"
-					"	}\n"
+					"#ifndef DEPTH_ONLY\n"
+					"	color = vec4(1.0, 1.0, 1.0, 1.0);\n"
+
+					"#ifdef VERTEX_COLOR\n"
+					"	color *= point.color;\n"
+					"#endif\n"
+
+					"#ifdef TEXTURED\n"
+					"	color *= texture(sampler, point.texCoord);\n"
+					"#endif\n"
 
+					"#ifdef BLOOM_OUTPUT\n"
 					"	color2 = vec4(0.0, 0.0, 0.0, 1.0);\n"
+					"#endif\n"
+					"#endif\n"
 					"}";
 
 			std::string vertexClip =
@@ -91,10 +309,12 @@ namespace simplicity
 					"// Variables\n"
 					"// /////////////////////////\n"
 
+					"#ifndef FULLSCREEN_TRIANGLE\n"
 					"layout (location = 0) in vec4 color;\n"
 					"layout (location = 1) in vec3 normal;\n"
 					"layout (location = 2) in vec3 position;\n"
 					"layout (location = 3) in vec2 texCoord;\n"
+					"#endif\n"
 
 					"out Point point;\n"
 
@@ -104,9 +324,18 @@ namespace simplicity
 
 					"void main()\n"
 					"{\n"
-					"	point.clipPosition = vec4(position, 1.0);\n"
+					"#ifdef FULLSCREEN_TRIANGLE\n"
+					"	// One triangle covering the screen, generated so that no vertex buffer is needed.\n"
+					"	vec2 texCoord = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));\n"
+					"	vec3 position = vec3(texCoord * 2.0 - 1.0, 0.0);\n"
+					"	point.color = vec4(1.0, 1.0, 1.0, 1.0);\n"
+					"	point.normal = vec3(0.0, 0.0, 1.0);\n"
+					"#else\n"
 					"	point.color = color;\n"
 					"	point.normal = normal;\n"
+					"#endif\n"
+
+					"	point.clipPosition = vec4(position, 1.0);\n"
 					"	point.texCoord = texCoord;\n"
 					"	point.worldPosition = position;\n"
 
@@ -138,10 +367,19 @@ namespace simplicity
 					"layout (location = 2) in vec3 position;\n"
 					"layout (location = 3) in vec2 texCoord;\n"
 
-					"uniform mat4 cameraTransform;\n"
+					"layout(std140) uniform FrameConstants\n"
+					"{\n"
+					"	mat4 cameraTransform;\n"
+					"};\n"
+
 					"uniform mat4 worldTransform;\n"
 
+					"#ifndef DEPTH_ONLY\n"
 					"out Point point;\n"
+					"#endif\n"
+
+					"// Variants must agree exactly for the depth pre-pass' equal depth test.\n"
+					"invariant gl_Position;\n"
 
 					"// /////////////////////////\n"
 					"// Shader\n"
@@ -152,6 +390,7 @@ namespace simplicity
 					"	vec4 worldPosition = worldTransform * vec4(position, 1.0);\n"
 					"	vec4 clipPosition = cameraTransform * worldPosition;\n"
 
+					"#ifndef DEPTH_ONLY\n"
 					"	mat4 worldRotation = worldTransform;\n"
 					"	worldRotation[3][0] = 0.0f;\n"
 					"	worldRotation[3][1] = 0.0f;\n"
@@ -164,6 +403,7 @@ namespace simplicity
 					"	point.normal = worldNormal.xyz;\n"
 					"	point.texCoord = texCoord;\n"
 					"	point.worldPosition = worldPosition.xyz;\n"
+					"#endif\n"
 
 					"	gl_Position = clipPosition;\n"
 					"}";
@@ -18,6 +18,7 @@
 
 #include "../common/OpenGL.h"
 #include "../model/OpenGLMeshBuffer.h"
+#include "OpenGLPipeline.h"
 #include "SimpleOpenGLRenderer.h"
 
 using namespace std;
@@ -35,18 +36,45 @@ namespace simplicity
 
 			int drawingMode = getOpenGLDrawingMode(buffer.getPrimitiveType());
 
+			// The pipeline has already been applied, switch to the variant each model needs as we go.
+			OpenGLPipeline* pipeline = static_cast<OpenGLPipeline*>(getDefaultPipeline());
+			OpenGLPipeline* appliedPipeline = pipeline;
+
 			for (const pair<Model*, Matrix44>& modelAndTransform : modelsAndTransforms)
 			{
 				const Model* model = modelAndTransform.first;
-				getDefaultPipeline()->set("worldTransform", modelAndTransform.second);
+
+				unsigned int features = OpenGLPipeline::getBaseFeatures();
+				if (model->getTexture() != nullptr)
+				{
+					features |= OpenGLPipeline::TEXTURED;
+				}
+				else
+				{
+					features |= OpenGLPipeline::VERTEX_COLOR;
+				}
+
+				OpenGLPipeline& variant = pipeline->getVariant(features);
+				if (&variant != appliedPipeline)
+				{
+					variant.apply();
+					appliedPipeline = &variant;
+
+					if ((features & OpenGLPipeline::TEXTURED) != 0)
+					{
+						variant.set("sampler", 0);
+					}
+				}
+
+				variant.set("worldTransform", modelAndTransform.second);
 
 				if (model->getTexture() != nullptr)
 				{
 					model->getTexture()->apply();
-					getDefaultPipeline()->set("sampler", 0);
-					getDefaultPipeline()->set("samplerEnabled", 1);
 				}
 
+				variant.flush();
+
 				if (buffer.isIndexed())
 				{
 					glDrawElementsBaseVertex(
@@ -65,8 +93,6 @@ namespace simplicity
 							buffer.getVertexCount(*model->getMesh()));
 					OpenGL::checkError();
 				}
-
-				getDefaultPipeline()->set("samplerEnabled", 0);
 			}
 		}
 	}
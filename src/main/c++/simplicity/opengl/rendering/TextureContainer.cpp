@@ -0,0 +1,575 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <simplicity/logging/Logs.h>
+
+#include "TextureContainer.h"
+
+using namespace std;
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		namespace TextureContainer
+		{
+			namespace
+			{
+				const unsigned char KTX_IDENTIFIER[12] =
+				{
+					0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+				};
+
+				const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+				struct KTXHeader
+				{
+					unsigned char identifier[12];
+
+					uint32_t endianness;
+
+					uint32_t glType;
+
+					uint32_t glTypeSize;
+
+					uint32_t glFormat;
+
+					uint32_t glInternalFormat;
+
+					uint32_t glBaseInternalFormat;
+
+					uint32_t pixelWidth;
+
+					uint32_t pixelHeight;
+
+					uint32_t pixelDepth;
+
+					uint32_t numberOfArrayElements;
+
+					uint32_t numberOfFaces;
+
+					uint32_t numberOfMipmapLevels;
+
+					uint32_t bytesOfKeyValueData;
+				};
+
+				const char DDS_MAGIC[4] = { 'D', 'D', 'S', ' ' };
+
+				const uint32_t DDS_CAPS2_CUBEMAP = 0x200;
+
+				const uint32_t DDS_CAPS2_VOLUME = 0x200000;
+
+				const uint32_t DDS_PIXEL_FORMAT_FOURCC = 0x4;
+
+				const uint32_t DDS_PIXEL_FORMAT_RGB = 0x40;
+
+				const uint32_t DDS_RESOURCE_DIMENSION_TEXTURE3D = 4;
+
+				const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+				struct DDSPixelFormat
+				{
+					uint32_t size;
+
+					uint32_t flags;
+
+					uint32_t fourCC;
+
+					uint32_t rgbBitCount;
+
+					uint32_t rBitMask;
+
+					uint32_t gBitMask;
+
+					uint32_t bBitMask;
+
+					uint32_t aBitMask;
+				};
+
+				struct DDSHeader
+				{
+					uint32_t size;
+
+					uint32_t flags;
+
+					uint32_t height;
+
+					uint32_t width;
+
+					uint32_t pitchOrLinearSize;
+
+					uint32_t depth;
+
+					uint32_t mipMapCount;
+
+					uint32_t reserved1[11];
+
+					DDSPixelFormat pixelFormat;
+
+					uint32_t caps;
+
+					uint32_t caps2;
+
+					uint32_t caps3;
+
+					uint32_t caps4;
+
+					uint32_t reserved2;
+				};
+
+				struct DDSHeaderDX10
+				{
+					uint32_t dxgiFormat;
+
+					uint32_t resourceDimension;
+
+					uint32_t miscFlag;
+
+					uint32_t arraySize;
+
+					uint32_t miscFlags2;
+				};
+
+				struct DDSFormat
+				{
+					/**
+					 * <p>
+					 * The size of a 4x4 block in bytes, 0 for uncompressed formats.
+					 * </p>
+					 */
+					unsigned int blockSize;
+
+					unsigned int bytesPerPixel;
+
+					GLenum format;
+
+					GLenum internalFormat;
+
+					GLenum type;
+				};
+
+				uint32_t fourCC(char a, char b, char c, char d)
+				{
+					return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+						(static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+				}
+
+				DDSFormat compressedFormat(GLenum internalFormat, unsigned int blockSize)
+				{
+					return { blockSize, 0, 0, internalFormat, 0 };
+				}
+
+				DDSFormat uncompressedFormat(GLenum internalFormat, GLenum format, GLenum type,
+						unsigned int bytesPerPixel)
+				{
+					return { 0, bytesPerPixel, format, internalFormat, type };
+				}
+
+				bool getDDSFormat(const DDSPixelFormat& pixelFormat, DDSFormat& format)
+				{
+					if ((pixelFormat.flags & DDS_PIXEL_FORMAT_FOURCC) != 0)
+					{
+						if (pixelFormat.fourCC == fourCC('D', 'X', 'T', '1'))
+						{
+							format = compressedFormat(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8);
+							return true;
+						}
+						if (pixelFormat.fourCC == fourCC('D', 'X', 'T', '3'))
+						{
+							format = compressedFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 16);
+							return true;
+						}
+						if (pixelFormat.fourCC == fourCC('D', 'X', 'T', '5'))
+						{
+							format = compressedFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16);
+							return true;
+						}
+						if (pixelFormat.fourCC == fourCC('A', 'T', 'I', '1') ||
+							pixelFormat.fourCC == fourCC('B', 'C', '4', 'U'))
+						{
+							format = compressedFormat(GL_COMPRESSED_RED_RGTC1, 8);
+							return true;
+						}
+						if (pixelFormat.fourCC == fourCC('A', 'T', 'I', '2') ||
+							pixelFormat.fourCC == fourCC('B', 'C', '5', 'U'))
+						{
+							format = compressedFormat(GL_COMPRESSED_RG_RGTC2, 16);
+							return true;
+						}
+
+						// D3DFMT_A16B16G16R16F and D3DFMT_A32B32G32R32F are stored as plain numbers.
+						if (pixelFormat.fourCC == 113)
+						{
+							format = uncompressedFormat(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8);
+							return true;
+						}
+						if (pixelFormat.fourCC == 116)
+						{
+							format = uncompressedFormat(GL_RGBA32F, GL_RGBA, GL_FLOAT, 16);
+							return true;
+						}
+
+						return false;
+					}
+
+					if ((pixelFormat.flags & DDS_PIXEL_FORMAT_RGB) != 0 && pixelFormat.rgbBitCount == 32)
+					{
+						if (pixelFormat.rBitMask == 0x000000FF)
+						{
+							format = uncompressedFormat(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4);
+							return true;
+						}
+						if (pixelFormat.rBitMask == 0x00FF0000)
+						{
+							format = uncompressedFormat(GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4);
+							return true;
+						}
+					}
+
+					return false;
+				}
+
+				bool getDXGIFormat(uint32_t dxgiFormat, DDSFormat& format)
+				{
+					switch (dxgiFormat)
+					{
+						case 2: // DXGI_FORMAT_R32G32B32A32_FLOAT
+							format = uncompressedFormat(GL_RGBA32F, GL_RGBA, GL_FLOAT, 16);
+							return true;
+						case 10: // DXGI_FORMAT_R16G16B16A16_FLOAT
+							format = uncompressedFormat(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8);
+							return true;
+						case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+							format = uncompressedFormat(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4);
+							return true;
+						case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+							format = uncompressedFormat(GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4);
+							return true;
+						case 71: // DXGI_FORMAT_BC1_UNORM
+							format = compressedFormat(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8);
+							return true;
+						case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+							format = compressedFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 8);
+							return true;
+						case 74: // DXGI_FORMAT_BC2_UNORM
+							format = compressedFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 16);
+							return true;
+						case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+							format = compressedFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 16);
+							return true;
+						case 77: // DXGI_FORMAT_BC3_UNORM
+							format = compressedFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16);
+							return true;
+						case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+							format = compressedFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 16);
+							return true;
+						case 80: // DXGI_FORMAT_BC4_UNORM
+							format = compressedFormat(GL_COMPRESSED_RED_RGTC1, 8);
+							return true;
+						case 83: // DXGI_FORMAT_BC5_UNORM
+							format = compressedFormat(GL_COMPRESSED_RG_RGTC2, 16);
+							return true;
+						case 87: // DXGI_FORMAT_B8G8R8A8_UNORM
+							format = uncompressedFormat(GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4);
+							return true;
+						case 95: // DXGI_FORMAT_BC6H_UF16
+							format = compressedFormat(GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 16);
+							return true;
+						case 96: // DXGI_FORMAT_BC6H_SF16
+							format = compressedFormat(GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 16);
+							return true;
+						case 98: // DXGI_FORMAT_BC7_UNORM
+							format = compressedFormat(GL_COMPRESSED_RGBA_BPTC_UNORM, 16);
+							return true;
+						case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+							format = compressedFormat(GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 16);
+							return true;
+						default:
+							return false;
+					}
+				}
+
+				size_t getDDSImageSize(const DDSFormat& format, unsigned int width, unsigned int height,
+						unsigned int depth)
+				{
+					if (format.blockSize != 0)
+					{
+						return static_cast<size_t>(max((width + 3) / 4, 1u)) * max((height + 3) / 4, 1u) *
+							format.blockSize * depth;
+					}
+
+					return static_cast<size_t>(width) * height * depth * format.bytesPerPixel;
+				}
+
+				unsigned int getLevelDimension(unsigned int dimension, unsigned int level)
+				{
+					return max(dimension >> level, 1u);
+				}
+			}
+
+			Contents::Contents() :
+				alignment(4),
+				compressed(false),
+				depth(1),
+				format(0),
+				generateMipmaps(false),
+				height(0),
+				images(),
+				internalFormat(0),
+				levelCount(0),
+				target(GL_TEXTURE_2D),
+				type(0),
+				width(0)
+			{
+			}
+
+			bool isDDS(const char* data, size_t length)
+			{
+				return length >= sizeof(DDS_MAGIC) && memcmp(data, DDS_MAGIC, sizeof(DDS_MAGIC)) == 0;
+			}
+
+			bool isKTX(const char* data, size_t length)
+			{
+				return length >= sizeof(KTX_IDENTIFIER) && memcmp(data, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) == 0;
+			}
+
+			bool readDDS(const char* data, size_t length, Contents& contents)
+			{
+				if (length < sizeof(DDS_MAGIC) + sizeof(DDSHeader))
+				{
+					Logs::error("simplicity::opengl", "DDS container is truncated");
+					return false;
+				}
+
+				const DDSHeader* header = reinterpret_cast<const DDSHeader*>(data + sizeof(DDS_MAGIC));
+				size_t offset = sizeof(DDS_MAGIC) + sizeof(DDSHeader);
+
+				DDSFormat format;
+				unsigned int arraySize = 1;
+				bool cubeMap = (header->caps2 & DDS_CAPS2_CUBEMAP) != 0;
+				bool volume = (header->caps2 & DDS_CAPS2_VOLUME) != 0;
+
+				if ((header->pixelFormat.flags & DDS_PIXEL_FORMAT_FOURCC) != 0 &&
+					header->pixelFormat.fourCC == fourCC('D', 'X', '1', '0'))
+				{
+					if (length < offset + sizeof(DDSHeaderDX10))
+					{
+						Logs::error("simplicity::opengl", "DDS container is truncated");
+						return false;
+					}
+
+					const DDSHeaderDX10* headerDX10 = reinterpret_cast<const DDSHeaderDX10*>(data + offset);
+					offset += sizeof(DDSHeaderDX10);
+
+					if (!getDXGIFormat(headerDX10->dxgiFormat, format))
+					{
+						Logs::error("simplicity::opengl", "Unsupported DDS format (DXGI format %u)",
+								headerDX10->dxgiFormat);
+						return false;
+					}
+
+					arraySize = max(headerDX10->arraySize, 1u);
+					cubeMap = (headerDX10->miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+					volume = headerDX10->resourceDimension == DDS_RESOURCE_DIMENSION_TEXTURE3D;
+				}
+				else if (!getDDSFormat(header->pixelFormat, format))
+				{
+					Logs::error("simplicity::opengl", "Unsupported DDS pixel format");
+					return false;
+				}
+
+				unsigned int faceCount = cubeMap ? 6 : 1;
+
+				contents.alignment = 1;
+				contents.compressed = format.blockSize != 0;
+				contents.format = format.format;
+				contents.height = header->height;
+				contents.internalFormat = format.internalFormat;
+				contents.levelCount = max(header->mipMapCount, 1u);
+				contents.type = format.type;
+				contents.width = header->width;
+
+				if (volume)
+				{
+					contents.depth = max(header->depth, 1u);
+					contents.target = GL_TEXTURE_3D;
+				}
+				else if (cubeMap && arraySize > 1)
+				{
+					if (!GLEW_VERSION_4_0 && !GLEW_ARB_texture_cube_map_array)
+					{
+						Logs::error("simplicity::opengl", "Cube map array textures are not supported");
+						return false;
+					}
+
+					contents.depth = arraySize * faceCount;
+					contents.target = GL_TEXTURE_CUBE_MAP_ARRAY;
+				}
+				else if (cubeMap)
+				{
+					contents.target = GL_TEXTURE_CUBE_MAP;
+				}
+				else if (arraySize > 1)
+				{
+					contents.depth = arraySize;
+					contents.target = GL_TEXTURE_2D_ARRAY;
+				}
+				else
+				{
+					contents.target = GL_TEXTURE_2D;
+				}
+
+				// DDS stores every mip level of a layer/face before moving on to the next layer/face.
+				for (unsigned int layer = 0; layer < arraySize * faceCount; layer++)
+				{
+					for (unsigned int level = 0; level < contents.levelCount; level++)
+					{
+						Image image;
+						image.depth = volume ? getLevelDimension(contents.depth, level) : 1;
+						image.face = contents.target == GL_TEXTURE_CUBE_MAP ? layer : 0;
+						image.height = getLevelDimension(contents.height, level);
+						image.layer = contents.target == GL_TEXTURE_CUBE_MAP ? 0 : layer;
+						image.level = level;
+						image.width = getLevelDimension(contents.width, level);
+						image.size = getDDSImageSize(format, image.width, image.height, image.depth);
+						image.data = data + offset;
+
+						if (image.size > length - offset)
+						{
+							Logs::error("simplicity::opengl", "DDS container is truncated");
+							return false;
+						}
+
+						contents.images.push_back(image);
+						offset += image.size;
+					}
+				}
+
+				return true;
+			}
+
+			bool readKTX(const char* data, size_t length, Contents& contents)
+			{
+				if (length < sizeof(KTXHeader))
+				{
+					Logs::error("simplicity::opengl", "KTX container is truncated");
+					return false;
+				}
+
+				const KTXHeader* header = reinterpret_cast<const KTXHeader*>(data);
+				if (header->endianness != KTX_ENDIANNESS)
+				{
+					Logs::error("simplicity::opengl", "KTX containers with non native endianness are not supported");
+					return false;
+				}
+
+				if (header->pixelHeight == 0)
+				{
+					Logs::error("simplicity::opengl", "1D KTX containers are not supported");
+					return false;
+				}
+
+				unsigned int arrayElementCount = header->numberOfArrayElements;
+				unsigned int faceCount = header->numberOfFaces;
+
+				contents.alignment = 4;
+				contents.compressed = header->glType == 0;
+				contents.format = header->glFormat;
+				contents.generateMipmaps = header->numberOfMipmapLevels == 0;
+				contents.height = header->pixelHeight;
+				contents.internalFormat = header->glInternalFormat;
+				contents.levelCount = max(header->numberOfMipmapLevels, 1u);
+				contents.type = header->glType;
+				contents.width = header->pixelWidth;
+
+				if (header->pixelDepth > 0)
+				{
+					contents.depth = header->pixelDepth;
+					contents.target = GL_TEXTURE_3D;
+				}
+				else if (faceCount == 6 && arrayElementCount > 0)
+				{
+					if (!GLEW_VERSION_4_0 && !GLEW_ARB_texture_cube_map_array)
+					{
+						Logs::error("simplicity::opengl", "Cube map array textures are not supported");
+						return false;
+					}
+
+					contents.depth = arrayElementCount * faceCount;
+					contents.target = GL_TEXTURE_CUBE_MAP_ARRAY;
+				}
+				else if (faceCount == 6)
+				{
+					contents.target = GL_TEXTURE_CUBE_MAP;
+				}
+				else if (arrayElementCount > 0)
+				{
+					contents.depth = arrayElementCount;
+					contents.target = GL_TEXTURE_2D_ARRAY;
+				}
+				else
+				{
+					contents.target = GL_TEXTURE_2D;
+				}
+
+				size_t offset = sizeof(KTXHeader) + header->bytesOfKeyValueData;
+
+				// KTX stores every layer/face of a mip level before moving on to the next mip level.
+				for (unsigned int level = 0; level < contents.levelCount; level++)
+				{
+					if (offset > length || length - offset < sizeof(uint32_t))
+					{
+						Logs::error("simplicity::opengl", "KTX container is truncated");
+						return false;
+					}
+
+					uint32_t imageSize;
+					memcpy(&imageSize, data + offset, sizeof(imageSize));
+					offset += sizeof(imageSize);
+
+					// For non array cube maps the image size is the size of a single face, otherwise it covers the
+					// whole level.
+					unsigned int imageCount = contents.target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+					for (unsigned int face = 0; face < imageCount; face++)
+					{
+						if (imageSize > length - offset)
+						{
+							Logs::error("simplicity::opengl", "KTX container is truncated");
+							return false;
+						}
+
+						Image image;
+						image.data = data + offset;
+						image.depth = contents.target == GL_TEXTURE_3D ?
+								getLevelDimension(contents.depth, level) : contents.depth;
+						image.face = face;
+						image.height = getLevelDimension(contents.height, level);
+						image.layer = 0;
+						image.level = level;
+						image.size = imageSize;
+						image.width = getLevelDimension(contents.width, level);
+						contents.images.push_back(image);
+
+						// Faces and levels are padded to 4 bytes.
+						offset += (imageSize + 3) & ~3u;
+					}
+				}
+
+				return true;
+			}
+		}
+	}
+}
@@ -0,0 +1,149 @@
+/*      _                 _ _      _ _
+ *     (_)               | (_)    (_) |
+ *  ___ _ _ __ ___  _ __ | |_  ___ _| |_ _   _
+ * / __| | '_ ` _ \| '_ \| | |/ __| | __| | | |
+ * \__ \ | | | | | | |_) | | | (__| | |_| |_| |
+ * |___/_|_| |_| |_| .__/|_|_|\___|_|\__|\__, |
+ *                 | |                    __/ |
+ *                 |_|                   |___/
+ *
+ * This file is part of simplicity. See the LICENSE file for the full license governing this code.
+ */
+#ifndef TEXTURECONTAINER_H_
+#define TEXTURECONTAINER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <simplicity/common/Defines.h>
+
+namespace simplicity
+{
+	namespace opengl
+	{
+		/**
+		 * <p>
+		 * Reads GPU ready texture containers (KTX and DDS). Nothing is copied, the images point straight into the
+		 * container's data so it must outlive the contents.
+		 * </p>
+		 */
+		namespace TextureContainer
+		{
+			/**
+			 * <p>
+			 * A block of pixels that is uploaded with a single call.
+			 * </p>
+			 */
+			struct SIMPLE_API Image
+			{
+				const char* data;
+
+				/**
+				 * <p>
+				 * The number of slices/layers the image covers (1 for 2D and cube map textures).
+				 * </p>
+				 */
+				unsigned int depth;
+
+				/**
+				 * <p>
+				 * The cube map face (0 to 5), only used for non array cube maps.
+				 * </p>
+				 */
+				unsigned int face;
+
+				unsigned int height;
+
+				/**
+				 * <p>
+				 * The first slice/layer the image covers (for cube map arrays this is layer * 6 + face).
+				 * </p>
+				 */
+				unsigned int layer;
+
+				unsigned int level;
+
+				std::size_t size;
+
+				unsigned int width;
+			};
+
+			/**
+			 * <p>
+			 * The contents of a texture container.
+			 * </p>
+			 */
+			struct SIMPLE_API Contents
+			{
+				Contents();
+
+				unsigned int alignment;
+
+				bool compressed;
+
+				/**
+				 * <p>
+				 * The number of slices (3D textures) or layers (array textures, multiplied by 6 for cube map
+				 * arrays) in the base level.
+				 * </p>
+				 */
+				unsigned int depth;
+
+				GLenum format;
+
+				/**
+				 * <p>
+				 * The container only holds the base level, the rest of the mip chain needs to be generated.
+				 * </p>
+				 */
+				bool generateMipmaps;
+
+				unsigned int height;
+
+				std::vector<Image> images;
+
+				GLenum internalFormat;
+
+				unsigned int levelCount;
+
+				GLenum target;
+
+				GLenum type;
+
+				unsigned int width;
+			};
+
+			/**
+			 * @return True if the data is a DDS container, false otherwise.
+			 */
+			SIMPLE_API bool isDDS(const char* data, std::size_t length);
+
+			/**
+			 * @return True if the data is a KTX (1.1) container, false otherwise.
+			 */
+			SIMPLE_API bool isKTX(const char* data, std::size_t length);
+
+			/**
+			 * <p>
+			 * Reads a DDS container.
+			 * </p>
+			 *
+			 * @return True if the container could be read, false otherwise (the reason is logged).
+			 */
+			SIMPLE_API bool readDDS(const char* data, std::size_t length, Contents& contents);
+
+			/**
+			 * <p>
+			 * Reads a KTX (1.1) container.
+			 * </p>
+			 *
+			 * @return True if the container could be read, false otherwise (the reason is logged).
+			 */
+			SIMPLE_API bool readKTX(const char* data, std::size_t length, Contents& contents);
+		}
+	}
+}
+
+#endif /* TEXTURECONTAINER_H_ */